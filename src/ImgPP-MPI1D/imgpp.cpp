@@ -1,18 +1,28 @@
 /******************************************************************
  *  mpi_pipeline.cpp
  *  Сборка:   mpic++ -O3 mpi_pipeline.cpp -o mpi_pipeline
- *  Запуск:   mpirun -np 4 ./mpi_pipeline
+ *  Запуск:   mpirun -np 4 ./mpi_pipeline [blocking|overlap|fused [in.ppraw out.ppraw]]
  ******************************************************************/
 #include <mpi.h> 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <random>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
+#include "distributed/distributed.hpp"
 #include "pp/mat/mat.hpp"
+#include "pp/median/median.hpp"
 #include "pp/pixel/pixel.hpp"
+#include "pp/raw/raw.hpp"
 #include "pp/transformation/transformation.hpp"
+#include "pp/window/window.hpp"
 
+using distributed::Bands;
+using distributed::SplitWindows;
 using pp::Mat;
 
 constexpr int kPixelSize = 3; // r-g-b    
@@ -20,19 +30,31 @@ constexpr int kPixelSize = 3; // r-g-b
 constexpr std::size_t kRows   = 150;
 constexpr std::size_t kColls   = 150;
 constexpr std::size_t kBorderSize   = 3;
+// Сумма радиусов стадий (Median 7, Mean 7, Sobel, Threshold): halo,
+// которого хватает на всю цепочку без обменов между стадиями.
+constexpr std::size_t kFusedBorderSize = 3 + 3 + 1 + 0;
 
+// Способ обмена ghost-ячейками.
+enum class Exchange {
+    kBlocking,  // перед каждой стадией, фильтр после MPI_Waitall
+    kOverlap,   // перед каждой стадией, внутренние окна - во время обмена
+    kFused,     // один обмен halo kFusedBorderSize на все стадии
+};
 
-inline std::size_t GetRowsFor(int rank, int size)
+constexpr const char* kExchangeNames[] = {"blocking", "overlap", "fused"};
+
+
+inline std::size_t GetRowsFor(std::size_t rows, int rank, int size)
 {
-    const int base = kRows / size;
-    const int extra = kRows % size;
+    const int base = rows / size;
+    const int extra = rows % size;
     return base + (rank < extra ? 1 : 0);
 }
 
-inline std::size_t GetRowOffsetFor(int rank, int size)
+inline std::size_t GetRowOffsetFor(std::size_t rows, int rank, int size)
 {
-    const int base = kRows / size;
-    const int extra = kRows % size;
+    const int base = rows / size;
+    const int extra = rows % size;
 
     if(rank < extra) {
         return static_cast<std::size_t>(rank) * (base+1);
@@ -42,29 +64,70 @@ inline std::size_t GetRowOffsetFor(int rank, int size)
     }
 }
 
-void ExchangeGhostCells(Mat& local, int rank, int size, const MPI_Datatype& RowType)
+// Строка блока local вместе с ghost-ячейками; экстент равен step, чтобы
+// несколько таких строк шли с шагом строк Mat, а не подряд.
+MPI_Datatype MakeRowType(const Mat& local)
+{
+    MPI_Datatype rowBytes;
+    MPI_Type_contiguous(local.cols * kPixelSize, MPI_UINT8_T, &rowBytes);
+
+    MPI_Datatype rowType;
+    MPI_Type_create_resized(rowBytes, 0, local.step, &rowType);
+    MPI_Type_commit(&rowType);
+    MPI_Type_free(&rowBytes);
+
+    return rowType;
+}
+
+// Зеркалит края блока шириной width (не больше borderSize) там, где он
+// выходит на край кадра: левый и правый - у всех строк, затем верхний
+// (top) и нижний (bottom) целыми строками, как Mat::MakeMirrorBorder.
+void MirrorFrameEdges(Mat& local, std::size_t width, bool top, bool bottom)
 {
-    MPI_Request req[4];
+    const std::size_t b = local.borderSize;
+
+    for (std::size_t row = 0; row < local.rows; ++row) {
+        for (std::size_t i = 0; i < width; ++i) {
+            std::memcpy(local.GetPtr(row, b - 1 - i), local.GetPtr(row, b + i), kPixelSize);
+            std::memcpy(local.GetPtr(row, local.cols - b + i), local.GetPtr(row, local.cols - b - 1 - i), kPixelSize);
+        }
+    }
+
+    for (std::size_t i = 0; i < width; ++i) {
+        if (top) {
+            std::memcpy(local.GetPtr(b - 1 - i, 0), local.GetPtr(b + i, 0), local.cols * kPixelSize);
+        }
+        if (bottom) {
+            std::memcpy(local.GetPtr(local.rows - b + i, 0), local.GetPtr(local.rows - b - 1 - i, 0),
+                        local.cols * kPixelSize);
+        }
+    }
+}
 
+// Запускает обмен ghost-строками с соседями; завершить - MPI_Waitall(4, req, ...).
+// Ширина обмена - local.borderSize строк. Пока обмен идёт, собственные
+// строки блока можно читать, а ghost-строки - нет.
+void StartExchangeGhostCells(Mat& local, int rank, int size, const MPI_Datatype& RowType,
+                             MPI_Request req[4])
+{
+    const std::size_t b = local.borderSize;
     const int top = (rank > 0) ? rank - 1 : MPI_PROC_NULL;
     const int bottom = (rank < size - 1) ? rank + 1 : MPI_PROC_NULL; 
 
 
-    MPI_Isend(local.GetPtr(kBorderSize,      0), kBorderSize, RowType,
+    MPI_Isend(local.GetPtr(b,                0), b, RowType,
               top,   0, MPI_COMM_WORLD, &req[0]);
 
-    MPI_Irecv(local.GetPtr(0,                         0), kBorderSize, RowType,
+    MPI_Irecv(local.GetPtr(0,                         0), b, RowType,
               top,   0, MPI_COMM_WORLD, &req[1]);
 
-    const std::size_t start = local.rows - 2*kBorderSize;
+    const std::size_t start = local.rows - 2*b;
 
-    MPI_Isend(local.GetPtr(start,                     0), kBorderSize, RowType,
+    MPI_Isend(local.GetPtr(start,                     0), b, RowType,
               bottom, 0, MPI_COMM_WORLD, &req[2]);
 
-    MPI_Irecv(local.GetPtr(start + kBorderSize,       0), kBorderSize, RowType,
+    MPI_Irecv(local.GetPtr(start + b,                 0), b, RowType,
               bottom, 0, MPI_COMM_WORLD, &req[3]);
-
-    MPI_Waitall(4, req, MPI_STATUSES_IGNORE);
 }
 
 void InitImg(Mat& src, int rank, int size);
@@ -80,10 +143,75 @@ int main(int argc, char** argv)
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
 
+    if (argc != 1 && argc != 2 && argc != 4) {
+        if (rank == 0)
+            std::fprintf(stderr, "Usage: %s [blocking|overlap|fused [in.ppraw out.ppraw]]\n", argv[0]);
+        MPI_Finalize();
+        return 1;
+    }
+
+    std::vector<Exchange> modes = {Exchange::kBlocking, Exchange::kOverlap, Exchange::kFused};
+    if (argc > 1) {
+        const auto* it = std::find_if(std::begin(kExchangeNames), std::end(kExchangeNames),
+                                      [&](const char* name) { return std::strcmp(name, argv[1]) == 0; });
+        if (it == std::end(kExchangeNames)) {
+            if (rank == 0)
+                std::fprintf(stderr, "Unknown exchange: %s (blocking, overlap or fused)\n", argv[1]);
+            MPI_Finalize();
+            return 1;
+        }
+        modes = {static_cast<Exchange>(it - std::begin(kExchangeNames))};
+    }
+
+    // Кадр из файла .ppraw: каждый ранг читает и пишет только свою полосу
+    // строк (MPI-IO), целиком кадр не хранит ни один ранг. Без файла -
+    // синтетический кадр kRows x kColls, сверяемый с последовательным
+    // результатом correctImg.
+    const char* inPath = argc == 4 ? argv[2] : nullptr;
+    const char* outPath = argc == 4 ? argv[3] : nullptr;
+
+    std::size_t rows = kRows;
+    std::size_t cols = kColls;
+    pp::RawHeader header{};
+    MPI_File input = MPI_FILE_NULL;
+
+    if (inPath != nullptr) {
+        try {
+            header = distributed::OpenRawImage(inPath, input);
+        } catch (const std::exception& e) {
+            if (rank == 0)
+                std::fprintf(stderr, "%s\n", e.what());
+            MPI_Finalize();
+            return 1;
+        }
+        rows = header.rows;
+        cols = header.cols;
+    }
+
+    const std::size_t rowsLocal = GetRowsFor(rows, rank, size);
+    const std::size_t rowOffset = GetRowOffsetFor(rows, rank, size);
+    const std::size_t rowsWithGhostCells = rowsLocal + 2*kBorderSize;
+    const std::size_t colsWithGhostCells = cols + 2*kBorderSize;
+
+    // Соседям уходят собственные строки блока, и по ним же у края кадра
+    // строится зеркальная рамка, так что блок не может быть тоньше ширины
+    // обмена: kFusedBorderSize для слитной цепочки, kBorderSize для прочих.
+    const bool fusedRequested = std::find(modes.begin(), modes.end(), Exchange::kFused) != modes.end();
+    const std::size_t minRows = fusedRequested ? kFusedBorderSize : kBorderSize;
+    if (rows / size < minRows) {
+        if (rank == 0)
+            std::fprintf(stderr, "Cannot split %zu rows into %d blocks of at least %zu rows\n",
+                         rows, size, minRows);
+        if (inPath != nullptr)
+            MPI_File_close(&input);
+        MPI_Finalize();
+        return 1;
+    }
+
     double t;
 
     pp::Mat correctImg;
-    {
+    if (inPath == nullptr) {
         pp::Mat img1(kRows, kColls);
         pp::InitImg(img1);
         img1 = img1.CopyWithBorder(kBorderSize);
@@ -96,11 +224,11 @@ int main(int argc, char** argv)
         pp::Mat* imgNew = &img2;
 
         img->MakeMirrorBorder(kBorderSize);
-        pp::DoFilter(*img, *imgNew, pp::MedianFilterProc(7));
+        pp::DoFilter(*img, *imgNew, pp::HistogramMedianFilterProc(7));
         std::swap(img, imgNew);
         
         img->MakeMirrorBorder(kBorderSize);
-        pp::DoFilter(*img, *imgNew, pp::MeanFilterProc(7));
+        pp::DoFilter(*img, *imgNew, pp::FixedMeanFilterProc<7>());
         std::swap(img, imgNew);
 
         img->MakeMirrorBorder(kBorderSize);
@@ -118,73 +246,170 @@ int main(int argc, char** argv)
             std::printf("MPI(%d//%d ranks) (s)elapsed: %.3f s\n", rank, size, t);
     }
 
-    const std::size_t rowsLocal = GetRowsFor(rank, size);
-    const std::size_t rowsWithGhostCells = rowsLocal + 2*kBorderSize;
-    const std::size_t colsWithGhostCells = kColls + 2*kBorderSize;
-
     Mat cur(rowsWithGhostCells, colsWithGhostCells, kBorderSize);
     Mat nxt(cur.rows, cur.cols, kBorderSize);
-    
-    ::InitImg(cur, rank, size);
+    MPI_Datatype GhostRowType = MakeRowType(cur);
 
-    MPI_Datatype GhostRowType;
-    MPI_Type_contiguous(
-        (kColls + 2*kBorderSize) * kPixelSize,
-        MPI_UINT8_T,
-        &GhostRowType);
-    MPI_Type_commit(&GhostRowType); 
+    // Считаются только окна, дающие собственные строки блока. При overlap
+    // окна, которым ghost-строки не нужны, обрабатываются, пока идёт обмен,
+    // а верхняя и нижняя полосы по half строк - после MPI_Waitall.
+    auto runStage = [&](auto&& proc, bool overlap)
+    {
+        const std::size_t half = proc.kernelSize / 2;
+        const Bands rows = SplitWindows(kBorderSize - half, rowsLocal, half);
+        const std::size_t x = kBorderSize - half;
 
-    MPI_Barrier(MPI_COMM_WORLD);
-    double t0 = MPI_Wtime();                  
+        auto filterRows = [&](std::size_t begin, std::size_t end) {
+            if (begin < end) {
+                pp::DoFilter(cur, nxt, proc, pp::Rect(x, begin, cols, end - begin));
+            }
+        };
 
-    auto runStage = [&](auto&& proc)
-    {
+        MPI_Request req[4];
         cur.MakeMirrorBorder(kBorderSize); 
-        ExchangeGhostCells(cur, rank, size, GhostRowType);
-
-        pp::DoFilter(cur, nxt, proc);
+        StartExchangeGhostCells(cur, rank, size, GhostRowType, req);
+
+        if (overlap) {
+            filterRows(rows.innerBegin, rows.innerEnd);
+            MPI_Waitall(4, req, MPI_STATUSES_IGNORE);
+            filterRows(rows.begin, rows.innerBegin);
+            filterRows(rows.innerEnd, rows.end);
+        } else {
+            MPI_Waitall(4, req, MPI_STATUSES_IGNORE);
+            filterRows(rows.begin, rows.end);
+        }
         std::swap(cur, nxt);
     };
 
-    runStage(pp::MedianFilterProc(7));
-    runStage(pp::MeanFilterProc(7));
-    runStage(pp::SobelFilterProc());
-    runStage(pp::ThresholdFilterProc(20));
-
-    double dt = MPI_Wtime() - t0;
-    double dtMax;
-    MPI_Reduce(&dt, &dtMax, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
-
-    bool resultLocal = CmpImg(correctImg, cur, rank, size);
-    bool resultGlobal = false;
-
-    MPI_Reduce(
-        &resultLocal,
-        &resultGlobal,
-        1,
-        MPI_CXX_BOOL,
-        MPI_LAND,
-        0,
-        MPI_COMM_WORLD);
-
-    if (rank == 0) {
-        std::printf("\n");
-        std::printf("MPI(%d//%d ranks) (p)elapsed: %.3f s\n", rank, size, dt);
-        std::printf("MPI(%d//%d ranks) result: %d\n", rank, size, resultGlobal);
+    // Слитная цепочка: halo шириной kFusedBorderSize приходит один раз,
+    // каждая стадия считает собственные строки и ещё по halo строк со
+    // стороны соседа (повторяя его работу), где halo - сумма радиусов
+    // оставшихся стадий. Со стороны края кадра результат стадии
+    // достраивается зеркально, как MakeMirrorBorder перед следующей стадией.
+    const bool hasTop = rank > 0;
+    const bool hasBottom = rank < size - 1;
+
+    Mat fusedCur(rowsLocal + 2*kFusedBorderSize, cols + 2*kFusedBorderSize, kFusedBorderSize);
+    Mat fusedNxt(fusedCur.rows, fusedCur.cols, kFusedBorderSize);
+    MPI_Datatype FusedRowType = MakeRowType(fusedCur);
+    std::size_t halo = 0;
+
+    auto runFusedStage = [&](auto&& proc)
+    {
+        const std::size_t half = proc.kernelSize / 2;
+        halo -= half;
+
+        const std::size_t top = kFusedBorderSize - (hasTop ? halo : 0);
+        const std::size_t bottom = kFusedBorderSize + rowsLocal + (hasBottom ? halo : 0);
+
+        pp::DoFilter(fusedCur, fusedNxt, proc, pp::Rect(kFusedBorderSize - half, top - half, cols, bottom - top));
+        MirrorFrameEdges(fusedNxt, halo, !hasTop, !hasBottom);
+        std::swap(fusedCur, fusedNxt);
+    };
+
+    bool resultLocal = true;
+    Mat* result = nullptr;
+
+    auto runPipeline = [&](Exchange mode)
+    {
+        Mat& img = mode == Exchange::kFused ? fusedCur : cur;
+        if (inPath != nullptr)
+            distributed::ReadBlock(input, header, img, rowOffset, 0);
+        else
+            ::InitImg(img, rank, size);
+
+        MPI_Barrier(MPI_COMM_WORLD);
+        double t0 = MPI_Wtime();                  
+
+        if (mode == Exchange::kFused) {
+            MPI_Request req[4];
+            MirrorFrameEdges(fusedCur, kFusedBorderSize, !hasTop, !hasBottom);
+            StartExchangeGhostCells(fusedCur, rank, size, FusedRowType, req);
+            MPI_Waitall(4, req, MPI_STATUSES_IGNORE);
+
+            halo = kFusedBorderSize;
+            runFusedStage(pp::HistogramMedianFilterProc(7));
+            runFusedStage(pp::FixedMeanFilterProc<7>());
+            runFusedStage(pp::SobelFilterProc());
+            runFusedStage(pp::ThresholdFilterProc(20));
+        } else {
+            const bool overlap = mode == Exchange::kOverlap;
+            runStage(pp::HistogramMedianFilterProc(7), overlap);
+            runStage(pp::FixedMeanFilterProc<7>(), overlap);
+            runStage(pp::SobelFilterProc(), overlap);
+            runStage(pp::ThresholdFilterProc(20), overlap);
+        }
+
+        double dt = MPI_Wtime() - t0;
+        double dtMax;
+        MPI_Reduce(&dt, &dtMax, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+        if (inPath == nullptr)
+            resultLocal = CmpImg(correctImg, img, rank, size) && resultLocal;
+        result = &img;
+        return dtMax;
+    };
+
+    double dtBlocking = 0;
+    for (Exchange mode: modes) {
+        const char* name = kExchangeNames[static_cast<int>(mode)];
+        const double dt = runPipeline(mode);
+        if (mode == Exchange::kBlocking)
+            dtBlocking = dt;
+
+        if (rank == 0) {
+            std::printf("MPI(%d//%d ranks) (p)elapsed[%s]: %.3f s", rank, size, name, dt);
+            if (dtBlocking > 0 && mode != Exchange::kBlocking)
+                std::printf(", speedup %.2f", dtBlocking / dt);
+            std::printf("\n");
+        }
+    }
+
+    int rc = 0;
+    if (inPath != nullptr) {
+        MPI_File_close(&input);
+
+        if (result != nullptr) {
+            try {
+                distributed::WriteBlock(outPath, header, *result, rowOffset, 0);
+            } catch (const std::exception& e) {
+                if (rank == 0)
+                    std::fprintf(stderr, "%s\n", e.what());
+                rc = 1;
+            }
+        }
+    } else {
+        bool resultGlobal = false;
+
+        MPI_Reduce(
+            &resultLocal,
+            &resultGlobal,
+            1,
+            MPI_CXX_BOOL,
+            MPI_LAND,
+            0,
+            MPI_COMM_WORLD);
+
+        if (rank == 0) {
+            std::printf("MPI(%d//%d ranks) result: %d\n", rank, size, resultGlobal);
+            if (!resultGlobal)
+                rc = 1;
+        }
     }
 
+    MPI_Type_free(&FusedRowType);
     MPI_Type_free(&GhostRowType);
     MPI_Finalize();
-    return 0;
+    return rc;
 }
 
 void InitImg(Mat& src, int rank, int size) {
-    const auto rowOffset = GetRowOffsetFor(rank, size);
+    const auto rowOffset = GetRowOffsetFor(kRows, rank, size);
 
     for (std::size_t row = src.borderSize; row < src.rows - src.borderSize; ++row) {
         for (std::size_t col = src.borderSize; col < src.cols - src.borderSize; ++col) {
             const auto globalRow = row + rowOffset - src.borderSize;
-            const auto globalCol = col - kBorderSize;
+            const auto globalCol = col - src.borderSize;
             
             auto pixel = src.GetPixel(row, col);
             pixel.r() = (653 + globalRow * kColls + globalCol) % 256;
@@ -195,11 +420,12 @@ void InitImg(Mat& src, int rank, int size) {
 }
 
 bool CmpImg(Mat& img, Mat& stride, int rank, int size) {
-    const auto rowOffset = GetRowOffsetFor(rank, size);
+    const auto rowOffset = GetRowOffsetFor(kRows, rank, size);
 
     for (std::size_t row = stride.borderSize; row < stride.rows - stride.borderSize; ++row) {
         for (std::size_t col = stride.borderSize; col < stride.cols - stride.borderSize; ++col) {
-            auto pixelImg = img.GetPixel(row + rowOffset, col);
+            auto pixelImg = img.GetPixel(row - stride.borderSize + img.borderSize + rowOffset,
+                                         col - stride.borderSize + img.borderSize);
             auto pixelStride = stride.GetPixel(row, col);
 
             if(pixelImg.r() != pixelStride.r() ||
@@ -1,18 +1,34 @@
 /******************************************************************
  *  mpi_pipeline.cpp
  *  Сборка:   mpic++ -O3 mpi_pipeline.cpp -o mpi_pipeline
- *  Запуск:   mpirun -np 4 ./mpi_pipeline
+ *  Запуск:   mpirun -np 4 ./mpi_pipeline [blocking|overlap|fused [in.ppraw out.ppraw] | halo]
+ *  Гибрид:   OMP_NUM_THREADS=8 mpirun -np 2 ./imgpp_hybrid [...]
  ******************************************************************/
 #include <mpi.h> 
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+#include <algorithm>
 #include <cstdio>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <optional>
 #include <random>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
+#include "distributed/distributed.hpp"
 #include "pp/mat/mat.hpp"
+#include "pp/median/median.hpp"
 #include "pp/pixel/pixel.hpp"
+#include "pp/raw/raw.hpp"
 #include "pp/transformation/transformation.hpp"
+#include "pp/window/window.hpp"
 
+using distributed::Bands;
+using distributed::SplitWindows;
 using pp::Mat;
 
 constexpr int kPixelSize = 3; // r-g-b    
@@ -20,6 +36,18 @@ constexpr int kPixelSize = 3; // r-g-b
 constexpr std::size_t kRows   = 150;
 constexpr std::size_t kColls   = 150;
 constexpr std::size_t kBorderSize   = 3;
+// Сумма радиусов стадий (Median 7, Mean 7, Sobel, Threshold): halo,
+// которого хватает на всю цепочку без обменов между стадиями.
+constexpr std::size_t kFusedBorderSize = 3 + 3 + 1 + 0;
+
+// Способ обмена ghost-ячейками.
+enum class Exchange {
+    kBlocking,  // перед каждой стадией, фильтр после MPI_Waitall
+    kOverlap,   // перед каждой стадией, внутренние окна - во время обмена
+    kFused,     // один обмен halo kFusedBorderSize на все стадии
+};
+
+constexpr const char* kExchangeNames[] = {"blocking", "overlap", "fused"};
 
 enum { N, W, S, E };
 
@@ -46,47 +74,253 @@ void FillNeighboursCoords(MPI_Comm cart, int* nbr)
     MPI_Cart_shift(cart, 1, 1, &nbr[W], &nbr[E]);
 }
 
-void ExchangeGhostCells(Mat& local,
+// Строка блока local вместе с ghost-ячейками; экстент равен step, чтобы
+// несколько таких строк шли с шагом строк Mat, а не подряд.
+MPI_Datatype MakeRowType(const Mat& local)
+{
+    MPI_Datatype rowBytes;
+    MPI_Type_contiguous(local.cols * kPixelSize, MPI_UINT8_T, &rowBytes);
+
+    MPI_Datatype rowType;
+    MPI_Type_create_resized(rowBytes, 0, local.step, &rowType);
+    MPI_Type_commit(&rowType);
+    MPI_Type_free(&rowBytes);
+
+    return rowType;
+}
+
+// borderSize столбцов блока local по всей его высоте.
+MPI_Datatype MakeColType(const Mat& local)
+{
+    MPI_Datatype colType;
+    MPI_Type_vector(
+        local.rows,
+        kPixelSize*local.borderSize,
+        local.step,
+        MPI_UINT8_T,
+        &colType);
+    MPI_Type_commit(&colType);
+
+    return colType;
+}
+
+// Зеркалит края блока шириной width (не больше borderSize) там, где у него
+// нет соседа (край кадра): левый и правый - у всех строк, затем верхний
+// и нижний целыми строками, как Mat::MakeMirrorBorder.
+void MirrorFrameEdges(Mat& local, std::size_t width, const int* nbr)
+{
+    const std::size_t b = local.borderSize;
+
+    for (std::size_t row = 0; row < local.rows; ++row) {
+        for (std::size_t i = 0; i < width; ++i) {
+            if (nbr[W] == MPI_PROC_NULL) {
+                std::memcpy(local.GetPtr(row, b - 1 - i), local.GetPtr(row, b + i), kPixelSize);
+            }
+            if (nbr[E] == MPI_PROC_NULL) {
+                std::memcpy(local.GetPtr(row, local.cols - b + i), local.GetPtr(row, local.cols - b - 1 - i),
+                            kPixelSize);
+            }
+        }
+    }
+
+    for (std::size_t i = 0; i < width; ++i) {
+        if (nbr[N] == MPI_PROC_NULL) {
+            std::memcpy(local.GetPtr(b - 1 - i, 0), local.GetPtr(b + i, 0), local.cols * kPixelSize);
+        }
+        if (nbr[S] == MPI_PROC_NULL) {
+            std::memcpy(local.GetPtr(local.rows - b + i, 0), local.GetPtr(local.rows - b - 1 - i, 0),
+                        local.cols * kPixelSize);
+        }
+    }
+}
+
+// Двухфазный обмен производными типами (MakeRowType, MakeColType); рабочие
+// стадии используют HaloExchange, этот - только для сравнения в режиме halo.
+// Обмен идёт в две фазы: сначала столбцы W/E, затем строки N/S целиком,
+// вместе с уже полученными столбцами, поэтому углы доходят без обмена
+// с диагональными соседями. Каждая фаза завершается MPI_Waitall(4, req, ...).
+void StartExchangeGhostCols(Mat& local,
                    const int* nbr,             // соседи или MPI_PROC_NULL
-                   MPI_Datatype RowType,
-                   MPI_Datatype ColType)
+                   MPI_Datatype ColType,
+                   MPI_Request req[4])
 {
-    MPI_Request req[4];
-    std::size_t start;
+    const std::size_t b = local.borderSize;
 
-    MPI_Isend(local.GetPtr(0, kBorderSize), 1, ColType,
+    MPI_Isend(local.GetPtr(0, b), 1, ColType,
               nbr[W],   10, MPI_COMM_WORLD, &req[0]);
 
     MPI_Irecv(local.GetPtr(0, 0), 1, ColType,
               nbr[W],   10, MPI_COMM_WORLD, &req[1]);
 
-    start = local.cols - 2*kBorderSize;
+    const std::size_t start = local.cols - 2*b;
 
     MPI_Isend(local.GetPtr(0, start), 1, ColType,
               nbr[E], 10, MPI_COMM_WORLD, &req[2]);
 
-    MPI_Irecv(local.GetPtr(0, start + kBorderSize), 1, ColType,
+    MPI_Irecv(local.GetPtr(0, start + b), 1, ColType,
               nbr[E], 10, MPI_COMM_WORLD, &req[3]);
+}
 
-    MPI_Waitall(4, req, MPI_STATUSES_IGNORE);
-
+void StartExchangeGhostRows(Mat& local,
+                   const int* nbr,
+                   MPI_Datatype RowType,
+                   MPI_Request req[4])
+{
+    const std::size_t b = local.borderSize;
 
-    /* -------------------------- */
-    MPI_Isend(local.GetPtr(kBorderSize, 0), kBorderSize, RowType,
+    MPI_Isend(local.GetPtr(b, 0), b, RowType,
               nbr[N],   20, MPI_COMM_WORLD, &req[0]);
 
-    MPI_Irecv(local.GetPtr(0, 0), kBorderSize, RowType,
+    MPI_Irecv(local.GetPtr(0, 0), b, RowType,
               nbr[N],   20, MPI_COMM_WORLD, &req[1]);
 
-    start = local.rows - 2*kBorderSize;
+    const std::size_t start = local.rows - 2*b;
 
-    MPI_Isend(local.GetPtr(start,                     0), kBorderSize, RowType,
+    MPI_Isend(local.GetPtr(start,                     0), b, RowType,
               nbr[S], 20, MPI_COMM_WORLD, &req[2]);
 
-    MPI_Irecv(local.GetPtr(start + kBorderSize,       0), kBorderSize, RowType,
+    MPI_Irecv(local.GetPtr(start + b,                 0), b, RowType,
               nbr[S], 20, MPI_COMM_WORLD, &req[3]);
+}
+
+// Обмен ghost-ячейками шириной borderSize со всеми восемью соседями за одну
+// фазу. Стороны и углы блока копируются построчным memcpy в непрерывные
+// буферы, привязанные к постоянным запросам (MPI_Send_init/MPI_Recv_init):
+// MPI передаёт только непрерывные куски, а запросы создаются один раз на
+// размер блока. Буферы не зависят от Mat, поэтому обмен годится и для cur,
+// и для nxt. Края кадра не заполняются - их достраивает MirrorFrameEdges
+// после Finish.
+class HaloExchange {
+public:
+    HaloExchange(MPI_Comm cart, std::size_t rowsLocal, std::size_t colsLocal, std::size_t borderSize)
+    {
+        int dims[2], periods[2], coords[2];
+        MPI_Cart_get(cart, 2, dims, periods, coords);
+
+        const std::size_t b = borderSize;
+        const std::size_t len[2] = {rowsLocal, colsLocal};
+
+        // По оси: d = -1 - первые b собственных строк (столбцов), 0 - все,
+        // 1 - последние b; принимается в соседнюю с ними рамку.
+        auto sendRange = [&](int d, int axis) {
+            return d < 0 ? Range{b, b} : d == 0 ? Range{b, len[axis]} : Range{len[axis], b};
+        };
+        auto recvRange = [&](int d, int axis) {
+            return d < 0 ? Range{0, b} : d == 0 ? Range{b, len[axis]} : Range{b + len[axis], b};
+        };
+
+        for (int dr = -1; dr <= 1; ++dr) {
+            for (int dc = -1; dc <= 1; ++dc) {
+                const int peerCoords[2] = {coords[0] + dr, coords[1] + dc};
+                if ((dr == 0 && dc == 0) || peerCoords[0] < 0 || peerCoords[0] >= dims[0] ||
+                    peerCoords[1] < 0 || peerCoords[1] >= dims[1]) {
+                    continue;
+                }
+
+                Side side;
+                MPI_Cart_rank(cart, peerCoords, &side.peer);
+                side.sendTag = (dr + 1) * 3 + (dc + 1);
+                side.recvTag = (1 - dr) * 3 + (1 - dc);
+                side.sendRows = sendRange(dr, 0);
+                side.sendCols = sendRange(dc, 1);
+                side.recvRows = recvRange(dr, 0);
+                side.recvCols = recvRange(dc, 1);
+                side.sendBuf.resize(side.sendRows.count * side.sendCols.count * kPixelSize);
+                side.recvBuf.resize(side.recvRows.count * side.recvCols.count * kPixelSize);
+                sides_.push_back(std::move(side));
+            }
+        }
+
+        requests_.resize(2 * sides_.size());
+        for (std::size_t i = 0; i < sides_.size(); ++i) {
+            Side& side = sides_[i];
+            MPI_Recv_init(side.recvBuf.data(), side.recvBuf.size(), MPI_UINT8_T, side.peer, side.recvTag,
+                          cart, &requests_[2 * i]);
+            MPI_Send_init(side.sendBuf.data(), side.sendBuf.size(), MPI_UINT8_T, side.peer, side.sendTag,
+                          cart, &requests_[2 * i + 1]);
+        }
+    }
+
+    HaloExchange(const HaloExchange&) = delete;
+    HaloExchange& operator=(const HaloExchange&) = delete;
+
+    // Запросы освобождаются до MPI_Finalize.
+    ~HaloExchange()
+    {
+        for (auto& request: requests_) {
+            MPI_Request_free(&request);
+        }
+    }
+
+    // Копирует края local в буферы и запускает все передачи. До Finish
+    // собственные пиксели local можно читать, а ghost-ячейки - нет.
+    void Start(const Mat& local)
+    {
+        for (auto& side: sides_) {
+            Copy(side.sendRows, side.sendCols, [&](std::size_t row, std::size_t col, std::size_t offset,
+                                                   std::size_t bytes) {
+                std::memcpy(side.sendBuf.data() + offset, local.GetPtr(row, col), bytes);
+            });
+        }
+        if (!requests_.empty()) {
+            MPI_Startall(requests_.size(), requests_.data());
+        }
+    }
+
+    // Дожидается передач и раскладывает полученное в ghost-ячейки local.
+    void Finish(Mat& local)
+    {
+        if (!requests_.empty()) {
+            MPI_Waitall(requests_.size(), requests_.data(), MPI_STATUSES_IGNORE);
+        }
+
+        for (auto& side: sides_) {
+            Copy(side.recvRows, side.recvCols, [&](std::size_t row, std::size_t col, std::size_t offset,
+                                                   std::size_t bytes) {
+                std::memcpy(local.GetPtr(row, col), side.recvBuf.data() + offset, bytes);
+            });
+        }
+    }
+
+private:
+    struct Range {
+        std::size_t begin, count;
+    };
+
+    struct Side {
+        int peer = MPI_PROC_NULL;
+        int sendTag = 0;
+        int recvTag = 0;
+        Range sendRows, sendCols, recvRows, recvCols;
+        std::vector<uint8_t> sendBuf, recvBuf;
+    };
+
+    // Область rows x cols построчно: строка блока row, начиная со столбца col,
+    // и её смещение в непрерывном буфере.
+    template<class RowCopy>
+    static void Copy(const Range& rows, const Range& cols, RowCopy copy)
+    {
+        const std::size_t bytes = cols.count * kPixelSize;
+        for (std::size_t i = 0; i < rows.count; ++i) {
+            copy(rows.begin + i, cols.begin, i * bytes, bytes);
+        }
+    }
 
-    MPI_Waitall(4, req, MPI_STATUSES_IGNORE);
+    std::vector<Side> sides_;
+    std::vector<MPI_Request> requests_;
+};
+
+// Окна windows блока. В гибридной сборке (USE_OPENMP) их делит на полосы
+// строк команда потоков ранга; MPI вызывается только из главного потока
+// вне параллельных областей, поэтому хватает MPI_THREAD_FUNNELED.
+template<class Processor>
+void FilterWindows(Mat& src, Mat& dst, Processor proc, const pp::Rect& windows)
+{
+#ifdef USE_OPENMP
+    pp::ParallelDoFilter(src, dst, proc, windows);
+#else
+    pp::DoFilter(src, dst, proc, windows);
+#endif
 }
 
 void InitImg(Mat& src, int rank, int size);
@@ -99,11 +333,78 @@ void InitImg(Mat& local, int coords[2], int dims  [2]);
 
 int main(int argc, char** argv)
 {
+#ifdef USE_OPENMP
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+#else
     MPI_Init(&argc,&argv);
+#endif
     int rank, size;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
 
+    // Потоков на ранг - OMP_NUM_THREADS (по умолчанию 1), рангов - mpirun -np:
+    // -np 1 даёт чистый OpenMP, OMP_NUM_THREADS=1 - чистый MPI.
+    int threads = 1;
+#ifdef USE_OPENMP
+    if (provided < MPI_THREAD_FUNNELED) {
+        if (rank == 0)
+            std::fprintf(stderr, "MPI does not support MPI_THREAD_FUNNELED\n");
+        MPI_Finalize();
+        return 1;
+    }
+    if (std::getenv("OMP_NUM_THREADS") == nullptr)
+        omp_set_num_threads(1);
+    threads = omp_get_max_threads();
+#endif
+
+    if (argc != 1 && argc != 2 && argc != 4) {
+        if (rank == 0)
+            std::fprintf(stderr, "Usage: %s [blocking|overlap|fused [in.ppraw out.ppraw] | halo]\n", argv[0]);
+        MPI_Finalize();
+        return 1;
+    }
+
+    // halo: вместо конвейера замеряется время одного обмена ghost-ячейками.
+    const bool haloBenchmark = argc == 2 && std::strcmp(argv[1], "halo") == 0;
+
+    std::vector<Exchange> modes = {Exchange::kBlocking, Exchange::kOverlap, Exchange::kFused};
+    if (argc > 1 && !haloBenchmark) {
+        const auto* it = std::find_if(std::begin(kExchangeNames), std::end(kExchangeNames),
+                                      [&](const char* name) { return std::strcmp(name, argv[1]) == 0; });
+        if (it == std::end(kExchangeNames)) {
+            if (rank == 0)
+                std::fprintf(stderr, "Unknown exchange: %s (blocking, overlap, fused or halo)\n", argv[1]);
+            MPI_Finalize();
+            return 1;
+        }
+        modes = {static_cast<Exchange>(it - std::begin(kExchangeNames))};
+    }
+
+    // Кадр из файла .ppraw: каждый ранг читает и пишет только свой блок
+    // (MPI-IO), целиком кадр не хранит ни один ранг. Без файла -
+    // синтетический кадр kRows x kColls, сверяемый с последовательным
+    // результатом correctImg.
+    const char* inPath = argc == 4 ? argv[2] : nullptr;
+    const char* outPath = argc == 4 ? argv[3] : nullptr;
+
+    std::size_t rows = kRows;
+    std::size_t cols = kColls;
+    pp::RawHeader header{};
+    MPI_File input = MPI_FILE_NULL;
+
+    if (inPath != nullptr) {
+        try {
+            header = distributed::OpenRawImage(inPath, input);
+        } catch (const std::exception& e) {
+            if (rank == 0)
+                std::fprintf(stderr, "%s\n", e.what());
+            MPI_Finalize();
+            return 1;
+        }
+        rows = header.rows;
+        cols = header.cols;
+    }
 
     int dims[2] = {0, 0};
     MPI_Dims_create(size, 2, dims);     // заполняет dims[0] * dims[1] == size
@@ -119,35 +420,35 @@ int main(int argc, char** argv)
     int nbr[4];
     FillNeighboursCoords(cart, nbr);
 
-    const std::size_t rowsLocal = LocalLen (kRows,  coords[0], dims[0]);
-    const std::size_t colsLocal = LocalLen (kColls, coords[1], dims[1]);
+    const std::size_t rowsLocal = LocalLen (rows, coords[0], dims[0]);
+    const std::size_t colsLocal = LocalLen (cols, coords[1], dims[1]);
+    const std::size_t rowOffset = LocalOff (rows, coords[0], dims[0]);
+    const std::size_t colOffset = LocalOff (cols, coords[1], dims[1]);
 
     const std::size_t rowsWithGhostCells = rowsLocal + 2*kBorderSize;
     const std::size_t colsWithGhostCells = colsLocal + 2*kBorderSize;
 
-    const int kRowStrideBytes = colsWithGhostCells * kPixelSize;
-
-
-    MPI_Datatype RowType;
-    MPI_Type_contiguous(
-        colsWithGhostCells * kPixelSize,
-        MPI_UINT8_T,
-        &RowType);
-    MPI_Type_commit(&RowType);
-
-    MPI_Datatype ColType;
-    MPI_Type_vector(
-        rowsWithGhostCells,
-        kPixelSize*kBorderSize,
-        kRowStrideBytes,
-        MPI_UINT8_T,
-        &ColType);
-    MPI_Type_commit(&ColType);
+    // Соседям уходят собственные пиксели блока, и по ним же у края кадра
+    // строится зеркальная рамка, так что блок в обоих направлениях не может
+    // быть меньше ширины обмена: kFusedBorderSize для слитной цепочки,
+    // kBorderSize для прочих и для halo.
+    const bool fusedRequested = !haloBenchmark &&
+                                std::find(modes.begin(), modes.end(), Exchange::kFused) != modes.end();
+    const std::size_t minBlock = fusedRequested ? kFusedBorderSize : kBorderSize;
+    if (rows / dims[0] < minBlock || cols / dims[1] < minBlock) {
+        if (rank == 0)
+            std::fprintf(stderr, "Cannot split %zux%zu pixels into %dx%d blocks of at least %zux%zu pixels\n",
+                         rows, cols, dims[0], dims[1], minBlock, minBlock);
+        if (inPath != nullptr)
+            MPI_File_close(&input);
+        MPI_Finalize();
+        return 1;
+    }
 
     double t;
 
     pp::Mat correctImg;
-    {
+    if (inPath == nullptr && !haloBenchmark) {
         pp::Mat img1(kRows, kColls);
         pp::InitImg(img1);
         img1 = img1.CopyWithBorder(kBorderSize);
@@ -160,11 +461,11 @@ int main(int argc, char** argv)
         pp::Mat* imgNew = &img2;
 
         img->MakeMirrorBorder(kBorderSize);
-        pp::DoFilter(*img, *imgNew, pp::MedianFilterProc(7));
+        pp::DoFilter(*img, *imgNew, pp::HistogramMedianFilterProc(7));
         std::swap(img, imgNew);
         
         img->MakeMirrorBorder(kBorderSize);
-        pp::DoFilter(*img, *imgNew, pp::MeanFilterProc(7));
+        pp::DoFilter(*img, *imgNew, pp::FixedMeanFilterProc<7>());
         std::swap(img, imgNew);
 
         img->MakeMirrorBorder(kBorderSize);
@@ -184,59 +485,221 @@ int main(int argc, char** argv)
 
     Mat cur(rowsWithGhostCells, colsWithGhostCells, kBorderSize);
     Mat nxt(cur.rows, cur.cols, kBorderSize);
-    
-    ::InitImg(cur, coords, dims);
 
-    MPI_Barrier(MPI_COMM_WORLD);
-    double t0 = MPI_Wtime();                  
+    std::optional<HaloExchange> exchange;
+    exchange.emplace(cart, rowsLocal, colsLocal, kBorderSize);
 
-    auto runStage = [&](auto&& proc)
+    // Считаются только окна, дающие собственные пиксели блока. При overlap
+    // внутренние окна обрабатываются, пока идёт обмен, а полосы шириной
+    // half вдоль сторон - после него.
+    auto runStage = [&](auto&& proc, bool overlap)
     {
-        cur.MakeMirrorBorder(kBorderSize); 
-        ExchangeGhostCells(cur, nbr, RowType, ColType);
-
-        pp::DoFilter(cur, nxt, proc);
+        const std::size_t half = proc.kernelSize / 2;
+        const Bands rows = SplitWindows(kBorderSize - half, rowsLocal, half);
+        const Bands cols = SplitWindows(kBorderSize - half, colsLocal, half);
+
+        auto filter = [&](std::size_t top, std::size_t bottom, std::size_t left, std::size_t right) {
+            if (top < bottom && left < right) {
+                FilterWindows(cur, nxt, proc, pp::Rect(left, top, right - left, bottom - top));
+            }
+        };
+
+        exchange->Start(cur);
+
+        if (overlap) {
+            filter(rows.innerBegin, rows.innerEnd, cols.innerBegin, cols.innerEnd);
+            exchange->Finish(cur);
+            MirrorFrameEdges(cur, kBorderSize, nbr);
+
+            filter(rows.begin, rows.innerBegin, cols.begin, cols.end);
+            filter(rows.innerEnd, rows.end, cols.begin, cols.end);
+            filter(rows.innerBegin, rows.innerEnd, cols.begin, cols.innerBegin);
+            filter(rows.innerBegin, rows.innerEnd, cols.innerEnd, cols.end);
+        } else {
+            exchange->Finish(cur);
+            MirrorFrameEdges(cur, kBorderSize, nbr);
+
+            filter(rows.begin, rows.end, cols.begin, cols.end);
+        }
         std::swap(cur, nxt);
     };
 
-    runStage(pp::MedianFilterProc(7));
-    runStage(pp::MeanFilterProc(7));
-    runStage(pp::SobelFilterProc());
-    runStage(pp::ThresholdFilterProc(20));
-
-    double dt = MPI_Wtime() - t0;
-    double dtMax;
-    MPI_Reduce(&dt, &dtMax, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
-
-    bool resultLocal = CmpImg(correctImg, cur, coords, dims);
-    bool resultGlobal = false;
-
-    MPI_Reduce(
-        &resultLocal,
-        &resultGlobal,
-        1,
-        MPI_CXX_BOOL,
-        MPI_LAND,
-        0,
-        MPI_COMM_WORLD);
-
-    if (rank == 0) {
-        std::printf("\n");
-        std::printf("MPI(%d//%d ranks) (p)elapsed: %.3f s\n", rank, size, dt);
-        std::printf("MPI(%d//%d ranks) result: %d\n", rank, size, resultGlobal);
+    // Слитная цепочка: halo шириной kFusedBorderSize приходит один раз,
+    // каждая стадия считает собственные пиксели и ещё по halo со стороны
+    // соседей (повторяя их работу), где halo - сумма радиусов оставшихся
+    // стадий. Со стороны края кадра результат стадии достраивается
+    // зеркально, как MakeMirrorBorder перед следующей стадией.
+
+    Mat fusedCur(rowsLocal + 2*kFusedBorderSize, colsLocal + 2*kFusedBorderSize, kFusedBorderSize);
+    Mat fusedNxt(fusedCur.rows, fusedCur.cols, kFusedBorderSize);
+    std::optional<HaloExchange> fusedExchange;
+    fusedExchange.emplace(cart, rowsLocal, colsLocal, kFusedBorderSize);
+    std::size_t halo = 0;
+
+    auto runFusedStage = [&](auto&& proc)
+    {
+        const std::size_t half = proc.kernelSize / 2;
+        halo -= half;
+
+        const std::size_t top = kFusedBorderSize - (nbr[N] != MPI_PROC_NULL ? halo : 0);
+        const std::size_t bottom = kFusedBorderSize + rowsLocal + (nbr[S] != MPI_PROC_NULL ? halo : 0);
+        const std::size_t left = kFusedBorderSize - (nbr[W] != MPI_PROC_NULL ? halo : 0);
+        const std::size_t right = kFusedBorderSize + colsLocal + (nbr[E] != MPI_PROC_NULL ? halo : 0);
+
+        FilterWindows(fusedCur, fusedNxt, proc, pp::Rect(left - half, top - half, right - left, bottom - top));
+        MirrorFrameEdges(fusedNxt, halo, nbr);
+        std::swap(fusedCur, fusedNxt);
+    };
+
+    bool resultLocal = true;
+    Mat* result = nullptr;
+
+    auto runPipeline = [&](Exchange mode)
+    {
+        Mat& img = mode == Exchange::kFused ? fusedCur : cur;
+        if (inPath != nullptr)
+            distributed::ReadBlock(input, header, img, rowOffset, colOffset);
+        else
+            ::InitImg(img, coords, dims);
+
+        MPI_Barrier(MPI_COMM_WORLD);
+        double t0 = MPI_Wtime();                  
+
+        if (mode == Exchange::kFused) {
+            fusedExchange->Start(fusedCur);
+            fusedExchange->Finish(fusedCur);
+            MirrorFrameEdges(fusedCur, kFusedBorderSize, nbr);
+
+            halo = kFusedBorderSize;
+            runFusedStage(pp::HistogramMedianFilterProc(7));
+            runFusedStage(pp::FixedMeanFilterProc<7>());
+            runFusedStage(pp::SobelFilterProc());
+            runFusedStage(pp::ThresholdFilterProc(20));
+        } else {
+            const bool overlap = mode == Exchange::kOverlap;
+            runStage(pp::HistogramMedianFilterProc(7), overlap);
+            runStage(pp::FixedMeanFilterProc<7>(), overlap);
+            runStage(pp::SobelFilterProc(), overlap);
+            runStage(pp::ThresholdFilterProc(20), overlap);
+        }
+
+        double dt = MPI_Wtime() - t0;
+        double dtMax;
+        MPI_Reduce(&dt, &dtMax, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+        if (inPath == nullptr)
+            resultLocal = CmpImg(correctImg, img, coords, dims) && resultLocal;
+        result = &img;
+        return dtMax;
+    };
+
+    if (haloBenchmark) {
+        modes.clear();
+
+        // Среднее время одного обмена (максимум по рангам) на блоке cur.
+        auto measure = [&](auto&& exchangeOnce) {
+            constexpr int kIterations = 1000;
+            exchangeOnce();
+
+            MPI_Barrier(MPI_COMM_WORLD);
+            double t0 = MPI_Wtime();
+            for (int i = 0; i < kIterations; ++i) {
+                exchangeOnce();
+            }
+            double dt = (MPI_Wtime() - t0) / kIterations;
+            double dtMax;
+            MPI_Reduce(&dt, &dtMax, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+            return dtMax;
+        };
+
+        MPI_Datatype RowType = MakeRowType(cur);
+        MPI_Datatype ColType = MakeColType(cur);
+
+        // Оба варианта после обмена одинаково достраивают только края кадра,
+        // так что разница - время самого обмена.
+        const double dtTwoPhase = measure([&] {
+            MPI_Request req[4];
+            StartExchangeGhostCols(cur, nbr, ColType, req);
+            MPI_Waitall(4, req, MPI_STATUSES_IGNORE);
+            StartExchangeGhostRows(cur, nbr, RowType, req);
+            MPI_Waitall(4, req, MPI_STATUSES_IGNORE);
+            MirrorFrameEdges(cur, kBorderSize, nbr);
+        });
+        const double dtSinglePhase = measure([&] {
+            exchange->Start(cur);
+            exchange->Finish(cur);
+            MirrorFrameEdges(cur, kBorderSize, nbr);
+        });
+
+        if (rank == 0) {
+            std::printf("MPI(%d//%d ranks) halo %zux%zu: two-phase %.2f us, eight-neighbour %.2f us, speedup %.2f\n",
+                        rank, size, rowsLocal, colsLocal, dtTwoPhase * 1e6, dtSinglePhase * 1e6,
+                        dtTwoPhase / dtSinglePhase);
+        }
+
+        MPI_Type_free(&RowType);
+        MPI_Type_free(&ColType);
+    }
+
+    double dtBlocking = 0;
+    for (Exchange mode: modes) {
+        const char* name = kExchangeNames[static_cast<int>(mode)];
+        const double dt = runPipeline(mode);
+        if (mode == Exchange::kBlocking)
+            dtBlocking = dt;
+
+        if (rank == 0) {
+            std::printf("MPI(%d//%d ranks x %d threads) (p)elapsed[%s]: %.3f s", rank, size, threads, name, dt);
+            if (dtBlocking > 0 && mode != Exchange::kBlocking)
+                std::printf(", speedup %.2f", dtBlocking / dt);
+            std::printf("\n");
+        }
+    }
+
+    int rc = 0;
+    if (inPath != nullptr) {
+        MPI_File_close(&input);
+
+        if (result != nullptr) {
+            try {
+                distributed::WriteBlock(outPath, header, *result, rowOffset, colOffset);
+            } catch (const std::exception& e) {
+                if (rank == 0)
+                    std::fprintf(stderr, "%s\n", e.what());
+                rc = 1;
+            }
+        }
+    } else if (!haloBenchmark) {
+        bool resultGlobal = false;
+
+        MPI_Reduce(
+            &resultLocal,
+            &resultGlobal,
+            1,
+            MPI_CXX_BOOL,
+            MPI_LAND,
+            0,
+            MPI_COMM_WORLD);
+
+        if (rank == 0) {
+            std::printf("MPI(%d//%d ranks) result: %d\n", rank, size, resultGlobal);
+            if (!resultGlobal)
+                rc = 1;
+        }
     }
 
-    MPI_Type_free(&RowType);
-    MPI_Type_free(&ColType);
+    exchange.reset();
+    fusedExchange.reset();
     MPI_Finalize();
-    return 0;
+    return rc;
 }
 
 void InitImg(Mat& local, int coords[2], int dims  [2]) {
     const std::size_t rowOffset = LocalOff(kRows,  coords[0], dims[0]);
     const std::size_t colOffset = LocalOff(kColls, coords[1], dims[1]);
 
-    const std::size_t b = local.borderSize;           // = kBorderSize
+    const std::size_t b = local.borderSize;
 
     for (std::size_t row = b; row < local.rows - b; ++row) {
         for (std::size_t col = b; col < local.cols - b; ++col) {
@@ -264,7 +727,7 @@ bool CmpImg(const Mat& img, const Mat& block, int coords[2], int dims  [2]) {
             const std::size_t gr = rowOff + row - b;
             const std::size_t gc = colOff + col - b;
 
-            const auto& pixelImg = img  .GetPixel(gr + b, gc + b);
+            const auto& pixelImg = img  .GetPixel(gr + img.borderSize, gc + img.borderSize);
             const auto& pixelBlock= block.GetPixel(row,  col);
 
             if (pixelImg.r() != pixelBlock.r() || pixelImg.g() != pixelBlock.g() || pixelImg.b() != pixelBlock.b())
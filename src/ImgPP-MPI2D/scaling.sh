@@ -0,0 +1,24 @@
+#!/bin/sh
+# Отчёт о масштабировании гибрида на P ядрах: все разбиения P = ranks x threads,
+# от чистого MPI (P x 1) до чистого OpenMP (1 x P).
+# Запуск:   ./scaling.sh ./imgpp_hybrid 16 [blocking|overlap|fused [in.ppraw out.ppraw]]
+set -e
+
+bin=$1
+cores=$2
+shift 2
+
+printf "%6s %8s %10s\n" ranks threads "time, s"
+threads=1
+while [ "$threads" -le "$cores" ]; do
+    if [ $((cores % threads)) -eq 0 ]; then
+        ranks=$((cores / threads))
+        # Каждому рангу - threads соседних ядер, потоки к ним привязаны.
+        time=$(OMP_NUM_THREADS=$threads OMP_PROC_BIND=close OMP_PLACES=cores \
+            mpirun -np "$ranks" --map-by "slot:PE=$threads" --bind-to core \
+                -x OMP_NUM_THREADS -x OMP_PROC_BIND -x OMP_PLACES "$bin" "$@" |
+            sed -n 's/.*(p)elapsed\[[a-z]*\]: \([0-9.]*\) s.*/\1/p' | head -n 1)
+        printf "%6d %8d %10s\n" "$ranks" "$threads" "$time"
+    fi
+    threads=$((threads + 1))
+done
@@ -3,9 +3,11 @@
 #include <cstdio>
 #include <omp.h>
 #include <random>
+#include <stdexcept>
 #include <sys/select.h>
 #include <sys/time.h>
 
+#include "pp/affinity/affinity.hpp"
 #include "pp/mat/mat.hpp"
 #include "pp/pixel/pixel.hpp"
 #include "pp/transformation/transformation.hpp"
@@ -23,7 +25,8 @@ void DoFilter(pp::Mat& src, pp::Mat& dst, Processor proc) {
 
     // std::size_t rowStart = (threadId != 0)? 
 
-    #pragma omp for schedule(static, 64)
+    // Непрерывные полосы строк, как при первом касании Placement::kFirstTouch.
+    #pragma omp for schedule(static)
     for (std::size_t row = 0; row < src.rows - kernelSize + 1; ++row) {
         for (std::size_t col = 0; col < src.cols - kernelSize + 1; ++col) {
             pp::Rect rect(col, row, kernelSize, kernelSize);
@@ -43,11 +46,25 @@ double wtime()
 
 }
 
-int main() {
+// Запуск: imgpp_openmp [none|close|spread] - привязка потоков к ядрам.
+int main(int argc, char** argv) {
     const std::size_t kRows = 5000;//1080;
     const std::size_t kColls = 5000;//2048;
     const std::size_t kBorderSize = 3;
 
+    pp::ThreadBinding binding = pp::ThreadBinding::kNone;
+    try {
+        if (argc > 1) {
+            binding = pp::ParseThreadBinding(argv[1]);
+        }
+    } catch (const std::invalid_argument& e) {
+        fprintf(stderr, "%s (none, close or spread)\n", e.what());
+        return 1;
+    }
+    if (!pp::BindThreads(binding)) {
+        fprintf(stderr, "Cannot bind threads (%s), running unbound\n", pp::ToString(binding).c_str());
+    }
+
     // const int N = 1;
     omp_get_thread_num();
     
@@ -96,54 +113,73 @@ int main() {
 
     
 
-    pp::Mat img1(kRows, kColls);
-    img1 = img1.CopyWithBorder(kBorderSize);
-    pp::Mat img2(img1.rows, img1.cols, img1.borderSize);
-
-    bool result;
-    #pragma omp parallel shared(img1, img2)
-    {
-        #pragma omp barrier
-        #pragma omp master
+    // Параллельный конвейер на буферах img1, img2: время в t, результат
+    // сравнивается с correctImg.
+    auto runParallel = [&](pp::Mat& img1, pp::Mat& img2) {
+        bool result;
+        #pragma omp parallel shared(img1, img2)
         {
-            t = wtime();
-        }
+            #pragma omp barrier
+            #pragma omp master
+            {
+                t = wtime();
+            }
 
-        ::InitImg(img1);
-        pp::Mat* img = &img1;
-        pp::Mat* imgNew = &img2;
+            ::InitImg(img1);
+            pp::Mat* img = &img1;
+            pp::Mat* imgNew = &img2;
 
-        MakeMirrorBorder(*img, kBorderSize); 
-        ::DoFilter(*img, *imgNew, pp::MedianFilterProc(7));
-        std::swap(img, imgNew); 
-        
+            MakeMirrorBorder(*img, kBorderSize); 
+            ::DoFilter(*img, *imgNew, pp::MedianFilterProc(7));
+            std::swap(img, imgNew); 
 
-        MakeMirrorBorder(*img, kBorderSize); 
-        ::DoFilter(*img, *imgNew, pp::MeanFilterProc(7));
-        std::swap(img, imgNew);
 
-        MakeMirrorBorder(*img, kBorderSize); 
-        ::DoFilter(*img, *imgNew, pp::SobelFilterProc());
-        std::swap(img, imgNew);
+            MakeMirrorBorder(*img, kBorderSize); 
+            ::DoFilter(*img, *imgNew, pp::MeanFilterProc(7));
+            std::swap(img, imgNew);
 
+            MakeMirrorBorder(*img, kBorderSize); 
+            ::DoFilter(*img, *imgNew, pp::SobelFilterProc());
+            std::swap(img, imgNew);
 
-        MakeMirrorBorder(*img, kBorderSize); 
-        ::DoFilter(*img, *imgNew, pp::ThresholdFilterProc(20));
-        std::swap(img, imgNew);
 
-        
+            MakeMirrorBorder(*img, kBorderSize); 
+            ::DoFilter(*img, *imgNew, pp::ThresholdFilterProc(20));
+            std::swap(img, imgNew);
 
-        #pragma omp barrier
-        #pragma omp master
-        {
-            t = wtime() - t;
-            result = (*img == correctImg);
+
+
+            #pragma omp barrier
+            #pragma omp master
+            {
+                t = wtime() - t;
+                result = (*img == correctImg);
+            }
         }
-    }
-    
-    
+
+
+        return result;
+    };
+
+    // Как раньше: CopyWithBorder пишет img1 в главном потоке, и все его
+    // страницы оказываются на одном узле NUMA.
+    pp::Mat img1 = pp::Mat(kRows, kColls).CopyWithBorder(kBorderSize);
+    pp::Mat img2(img1.rows, img1.cols, img1.borderSize);
+
+    bool result = runParallel(img1, img2);
+    const double tMaster = t;
+    printf("Result: %d\n", result);
+    printf("(P)Elapsed time (sec.) [master touch]: %.12f\n", tMaster);
+
+    // Первое касание полосами строк тех же потоков, что их фильтруют.
+    const auto placement = pp::Mat::Placement::kFirstTouch;
+    pp::Mat touched1(kRows + 2 * kBorderSize, kColls + 2 * kBorderSize, kBorderSize, placement);
+    pp::Mat touched2(touched1.rows, touched1.cols, touched1.borderSize, placement);
+
+    result = runParallel(touched1, touched2);
     printf("Result: %d\n", result);
-    printf("(P)Elapsed time (sec.): %.12f\n", t);
+    printf("(P)Elapsed time (sec.) [first touch, bind=%s]: %.12f, speedup %.2f\n",
+           pp::ToString(binding).c_str(), t, tMaster / t);
 
 
 
@@ -151,7 +187,7 @@ int main() {
 }
 
 void InitImg(Mat& src) {
-    #pragma omp for schedule(static, 64)
+    #pragma omp for schedule(static)
     for (std::size_t row = src.borderSize; row < src.rows - src.borderSize; ++row) {
         for (std::size_t col = src.borderSize; col < src.cols - src.borderSize; ++col) {
             auto pixel = src.GetPixel(row, col);
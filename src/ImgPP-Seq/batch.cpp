@@ -0,0 +1,196 @@
+#include "batch.hpp"
+
+#include "imgio/imgio.hpp"
+#include "pp/pool/pool.hpp"
+#include "pp/scheduler/scheduler.hpp"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace batch {
+namespace {
+
+namespace fs = std::filesystem;
+
+bool IsImageFile(const fs::path& path) {
+    static const char* const kExtensions[] = {
+        ".png", ".jpg", ".jpeg", ".bmp", ".tif", ".tiff", ".webp", ".ppm", ".pnm", ".ppraw",
+    };
+
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+
+    return std::find(std::begin(kExtensions), std::end(kExtensions), extension) != std::end(kExtensions);
+}
+
+// * - любая подстрока, ? - любой символ.
+bool Match(const char* pattern, const char* name) {
+    if (*pattern == '\0') {
+        return *name == '\0';
+    }
+    if (*pattern == '*') {
+        return Match(pattern + 1, name) || (*name != '\0' && Match(pattern, name + 1));
+    }
+    return *name != '\0' && (*pattern == '?' || *pattern == *name) && Match(pattern + 1, name + 1);
+}
+
+std::vector<fs::path> ListInputs(const std::string& input) {
+    std::vector<fs::path> paths;
+
+    if (fs::is_directory(input)) {
+        for (const auto& entry: fs::directory_iterator(input)) {
+            if (entry.is_regular_file() && IsImageFile(entry.path())) {
+                paths.push_back(entry.path());
+            }
+        }
+    } else if (input.find_first_of("*?") != std::string::npos) {
+        const fs::path pattern(input);
+        const fs::path dir = pattern.has_parent_path() ? pattern.parent_path() : fs::path(".");
+        if (dir.string().find_first_of("*?") != std::string::npos) {
+            throw std::runtime_error("Batch patterns are supported only in file names: " + input);
+        }
+        const std::string name = pattern.filename().string();
+        for (const auto& entry: fs::directory_iterator(dir)) {
+            if (entry.is_regular_file() && Match(name.c_str(), entry.path().filename().string().c_str())) {
+                paths.push_back(entry.path());
+            }
+        }
+    } else {
+        // Список: путь на строку, пустые строки и строки с # пропускаются.
+        std::ifstream manifest(input);
+        if (!manifest) {
+            throw std::runtime_error("Cannot open batch input: " + input);
+        }
+        std::string line;
+        while (std::getline(manifest, line)) {
+            const auto begin = line.find_first_not_of(" \t\r");
+            if (begin == std::string::npos || line[begin] == '#') {
+                continue;
+            }
+            const auto end = line.find_last_not_of(" \t\r");
+            paths.emplace_back(line.substr(begin, end - begin + 1));
+        }
+        return paths;
+    }
+
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+struct Frame {
+    const Item* item = nullptr;
+    pp::Mat img;
+    pp::Plane gray;
+};
+
+} // namespace
+
+std::vector<Item> ListItems(const configuration::BatchParams& params) {
+    std::vector<Item> items;
+    for (const auto& path: ListInputs(params.input)) {
+        fs::path out = fs::path(params.outputDir) / path.filename();
+        if (!params.format.empty()) {
+            out.replace_extension(params.format);
+        }
+        items.push_back(Item{path.string(), out.string()});
+    }
+
+    return items;
+}
+
+std::size_t Run(const configuration::FilterPipelineParams& config, const std::vector<Item>& items) {
+    const auto& params = config.batch;
+    fs::create_directories(params.outputDir);
+
+    pp::BoundedQueue<Frame> decoded(params.queueSize);
+    pp::BoundedQueue<Frame> filtered(params.queueSize);
+    pp::MatPool pool;
+
+    std::atomic<std::size_t> next{0};
+    std::atomic<std::size_t> failures{0};
+    std::atomic<std::size_t> decoders{params.decodeThreads};
+    std::atomic<std::size_t> computers{params.computeThreads};
+    std::mutex logMutex;
+
+    auto fail = [&](const Item& item, const std::exception& e) {
+        std::lock_guard<std::mutex> lock(logMutex);
+        std::cerr << item.in << ": " << e.what() << "\n";
+        ++failures;
+    };
+
+    // Последний поток стадии закрывает её выходную очередь.
+    auto decode = [&] {
+        for (std::size_t i = next++; i < items.size(); i = next++) {
+            try {
+                decoded.Push(Frame{&items[i], imgio::ReadImage(items[i].in), pp::Plane()});
+            } catch (const std::exception& e) {
+                fail(items[i], e);
+            }
+        }
+        if (--decoders == 0) {
+            decoded.Close();
+        }
+    };
+
+    auto compute = [&] {
+        // Число потоков OpenMP задаётся для каждого потока отдельно.
+        omp_set_num_threads(config.numThreads);
+
+        Frame frame;
+        while (decoded.Pop(frame)) {
+            try {
+                config.process(frame.img, frame.gray, pool);
+                filtered.Push(std::move(frame));
+            } catch (const std::exception& e) {
+                fail(*frame.item, e);
+            }
+        }
+        if (--computers == 0) {
+            filtered.Close();
+        }
+    };
+
+    auto encode = [&] {
+        Frame frame;
+        while (filtered.Pop(frame)) {
+            try {
+                const bool written = config.grayscale ? imgio::WriteImage(frame.item->out, frame.gray)
+                                                      : imgio::WriteImage(frame.item->out, frame.img);
+                if (!written) {
+                    throw std::runtime_error("Cannot write image: " + frame.item->out);
+                }
+            } catch (const std::exception& e) {
+                fail(*frame.item, e);
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < params.decodeThreads; ++i) {
+        threads.emplace_back(decode);
+    }
+    for (std::size_t i = 0; i < params.computeThreads; ++i) {
+        threads.emplace_back(compute);
+    }
+    for (std::size_t i = 0; i < params.encodeThreads; ++i) {
+        threads.emplace_back(encode);
+    }
+    for (auto& thread: threads) {
+        thread.join();
+    }
+
+    return failures;
+}
+
+} // namespace batch
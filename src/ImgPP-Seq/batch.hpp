@@ -0,0 +1,31 @@
+#ifndef IMAGE_PREPROCESSING_IMGPP_SEQ_BATCH_HPP_
+#define IMAGE_PREPROCESSING_IMGPP_SEQ_BATCH_HPP_
+
+#include "configuration/parser/parser.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace batch {
+
+struct Item {
+    std::string in;
+    std::string out;
+};
+
+// Кадры пакета (см. configuration::BatchParams) в порядке имён; ошибки
+// чтения каталога или списка - std::runtime_error.
+std::vector<Item> ListItems(const configuration::BatchParams& params);
+
+// Прогоняет items через config конвейером из трёх стадий: потоки
+// декодирования, потоки фильтров и потоки кодирования, связанные очередями
+// pp::BoundedQueue. В работе одновременно не больше
+// decodeThreads + computeThreads + encodeThreads + 2 * queueSize кадров.
+// Кадр с ошибкой пропускается с сообщением в std::cerr; возвращает число
+// таких кадров.
+std::size_t Run(const configuration::FilterPipelineParams& config, const std::vector<Item>& items);
+
+} // namespace batch
+
+#endif
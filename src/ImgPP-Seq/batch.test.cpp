@@ -0,0 +1,140 @@
+#include "batch.hpp"
+
+#include "imgio/imgio.hpp"
+#include "pp/pool/pool.hpp"
+#include "pp/raw/raw.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// Каталог с кадрами .ppraw разных размеров и посторонним файлом.
+class BatchTest : public testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = fs::temp_directory_path() /
+               ("imgpp_batch_" + std::string(testing::UnitTest::GetInstance()->current_test_info()->name()));
+        fs::remove_all(dir_);
+        fs::create_directories(dir_ / "in");
+
+        std::mt19937 rng(5);
+        std::uniform_int_distribution<std::size_t> extent(8, 60);
+        std::uniform_int_distribution<int> value(0, 255);
+        for (int i = 0; i < kFrames; ++i) {
+            pp::Mat frame(extent(rng), extent(rng));
+            for (std::size_t row = 0; row < frame.rows; ++row) {
+                for (std::size_t j = 0; j < frame.cols * 3; ++j) {
+                    frame.GetPtr(row, 0)[j] = static_cast<uint8_t>(value(rng));
+                }
+            }
+            pp::WriteRawImage(Input("frame" + std::to_string(i) + pp::kRawExtension), frame);
+        }
+        std::ofstream(Input("notes.txt")) << "not a frame\n";
+    }
+
+    void TearDown() override {
+        fs::remove_all(dir_);
+    }
+
+    std::string Input(const std::string& name) const {
+        return (dir_ / "in" / name).string();
+    }
+
+    configuration::FilterPipelineParams Config(const std::string& input, nlohmann::json batch,
+                                               bool grayscale = false) const {
+        nlohmann::json filters = nlohmann::json::array({
+            {{"type", "Median"}, {"kernel_size", 3}},
+            {{"type", "Mean"}, {"kernel_size", 3}},
+        });
+        if (grayscale) {
+            filters.push_back({{"type", "Grayscale"}});
+        }
+        filters.push_back({{"type", "Sobel"}});
+
+        batch["input"] = input;
+        batch["output_dir"] = (dir_ / "out").string();
+        nlohmann::json json = {{"filters", filters}, {"batch", batch}};
+
+        return configuration::parse(json);
+    }
+
+    // Каждый выход пакета совпадает с обработкой того же кадра по одному.
+    void ExpectSameAsSingleFrame(const configuration::FilterPipelineParams& config,
+                                 const std::vector<batch::Item>& items) {
+        for (const auto& item: items) {
+            SCOPED_TRACE(item.in);
+            pp::Mat img = imgio::ReadImage(item.in);
+            pp::Plane gray;
+            pp::MatPool pool;
+            config.process(img, gray, pool);
+
+            if (config.grayscale) {
+                EXPECT_TRUE(pp::ReadRawPlane(item.out) == gray);
+            } else {
+                EXPECT_TRUE(imgio::ReadImage(item.out) == img);
+            }
+        }
+    }
+
+    static constexpr int kFrames = 6;
+    fs::path dir_;
+};
+
+TEST_F(BatchTest, DirectoryMatchesSingleFrame) {
+    const auto config = Config((dir_ / "in").string(), {{"compute_threads", 2}});
+    const auto items = batch::ListItems(config.batch);
+    ASSERT_EQ(items.size(), static_cast<std::size_t>(kFrames));
+
+    EXPECT_EQ(batch::Run(config, items), 0u);
+    ExpectSameAsSingleFrame(config, items);
+}
+
+TEST_F(BatchTest, GlobMatchesSingleFrame) {
+    const auto config = Config(Input("frame*.ppraw"), {{"decode_threads", 3}, {"encode_threads", 1}});
+    const auto items = batch::ListItems(config.batch);
+    ASSERT_EQ(items.size(), static_cast<std::size_t>(kFrames));
+
+    EXPECT_EQ(batch::Run(config, items), 0u);
+    ExpectSameAsSingleFrame(config, items);
+}
+
+TEST_F(BatchTest, GrayscaleMatchesSingleFrame) {
+    const auto config = Config((dir_ / "in").string(), {{"compute_threads", 2}}, true);
+    const auto items = batch::ListItems(config.batch);
+
+    EXPECT_EQ(batch::Run(config, items), 0u);
+    ExpectSameAsSingleFrame(config, items);
+}
+
+// Очереди на один кадр при нескольких потоках каждой стадии: Run должен
+// завершиться (зависание ловит TIMEOUT теста в CMakeLists.txt).
+TEST_F(BatchTest, SingleSlotQueuesDoNotDeadlock) {
+    const auto config = Config((dir_ / "in").string(),
+                               {{"queue_size", 1}, {"decode_threads", 2}, {"compute_threads", 4}, {"encode_threads", 2}});
+    const auto items = batch::ListItems(config.batch);
+
+    for (int run = 0; run < 20; ++run) {
+        ASSERT_EQ(batch::Run(config, items), 0u);
+    }
+    ExpectSameAsSingleFrame(config, items);
+}
+
+TEST_F(BatchTest, BrokenFrameIsSkipped) {
+    std::ofstream(Input("broken" + std::string(pp::kRawExtension))) << "PPRAW";
+    const auto config = Config((dir_ / "in").string(), {{"queue_size", 1}, {"compute_threads", 2}});
+    const auto items = batch::ListItems(config.batch);
+    ASSERT_EQ(items.size(), static_cast<std::size_t>(kFrames + 1));
+
+    EXPECT_EQ(batch::Run(config, items), 1u);
+}
+
+} // namespace
@@ -8,9 +8,15 @@
 
 #include <omp.h>
 
+#include "batch.hpp"
 #include "configuration/parser/parser.hpp"
+#include "imgio/imgio.hpp"
+#include "pp/affinity/affinity.hpp"
 #include "pp/mat/mat.hpp"
+#include "pp/pipeline/pipeline.hpp"
 #include "pp/pixel/pixel.hpp"
+#include "pp/planar/planar.hpp"
+#include "pp/pool/pool.hpp"
 #include "pp/transformation/transformation.hpp"
 
 using cv::Vec3b;
@@ -35,24 +41,53 @@ int main() {
     config.log();
 
     omp_set_num_threads(config.numThreads);
+    if (!pp::BindThreads(config.binding)) {
+        fprintf(stderr, "Cannot bind threads (%s), running unbound\n", pp::ToString(config.binding).c_str());
+    }
 
     pp::Mat img;
+    pp::Plane gray;
+    pp::MatPool pool;
 
     double sum_t = 0;
     double t;
 
     int N = 1;
 
-    for(auto i = 0; i < 1; ++i) {
-        cv::Mat img__ = cv::imread(config.in);
-        img = pp::Mat(img__.rows, img__.cols, img__.data);
+    if (config.batch.enabled()) {
+        const auto items = batch::ListItems(config.batch);
 
         t = omp_get_wtime();
+        const std::size_t failures = batch::Run(config, items);
+        t = omp_get_wtime() - t;
+        printf("Batch: %zu frames, %zu failed, elapsed time (sec.): %.12f\n", items.size(), failures, t);
+
+        return failures == 0 ? 0 : 1;
+    }
 
-        for(auto& filter: config.filters) {
-            auto tmp = filter->apply(img);
-            img.swap(tmp);
+    if (config.stripHeight > 0) {
+        // Потоковый режим: в памяти только полосы строк, а не весь кадр.
+        imgio::PpmReader reader(config.in);
+        imgio::PpmWriter writer(config.out, reader.Rows(), reader.Cols());
+        pp::StripPipeline pipeline(reader.Rows(), reader.Cols(), config.Stages(), config.stripHeight,
+                                   config.border, [&](const pp::Mat& strip) { writer.Write(strip); });
+        pp::Mat strip(config.stripHeight, reader.Cols());
+
+        t = omp_get_wtime();
+        while (const std::size_t rows = reader.Read(strip)) {
+            pipeline.Push(strip.Crop(pp::Rect(0, 0, strip.cols, rows)));
         }
+        printf("Elapsed time (sec.): %.12f\n", omp_get_wtime() - t);
+
+        return 0;
+    }
+
+    for(auto i = 0; i < 1; ++i) {
+        img = imgio::ReadImage(config.in);
+
+        t = omp_get_wtime();
+
+        config.process(img, gray, pool);
 
         sum_t += omp_get_wtime() - t;
     }
@@ -62,8 +97,11 @@ int main() {
     printf("Elapsed time (sec.): %.12f\n", sum_t / N);
 
     
-    cv::Mat i = cv::Mat(img.rows, img.cols, CV_8UC3, img.data);
-    cv::imwrite(config.out, i);
+    if (config.grayscale) {
+        imgio::WriteImage(config.out, gray);
+    } else {
+        imgio::WriteImage(config.out, img);
+    }
 
     // cv::imwrite("image01_res.jpg", i);
 
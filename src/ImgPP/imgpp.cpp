@@ -9,6 +9,8 @@
 #include <omp.h>
 
 // #include "configuration/parser/parser.hpp"
+#include "imgio/imgio.hpp"
+#include "pp/border/border.hpp"
 #include "pp/mat/mat.hpp"
 #include "pp/pixel/pixel.hpp"
 #include "pp/transformation/transformation.hpp"
@@ -42,12 +44,11 @@ int main() {
 
     int N = 1;
 
-    cv::Mat img__ = cv::imread("resources/img03n.png");
-    img = pp::Mat(img__.rows, img__.cols, (const unsigned char *) img__.data).CopyWithBorder(5);//.CopyWithBorder(50);
-    img.MakeMirrorBorder(5);
-    pp::Mat tmp = img;
+    img = imgio::ReadImage("resources/img03n.png");
+    pp::Mat tmp(img.rows, img.cols);
 
-    pp::DoFilter(tmp, img, pp::MedianFilterProc(5));
+    pp::DoFilter(img, tmp, pp::MedianFilterProc(5), pp::Border{});
+    tmp.swap(img);
 
     // img.MakeMirrorBorder(5);
     // pp::DoFilter(img, tmp, pp::MeanFilterProc(3));
@@ -60,7 +61,6 @@ int main() {
 
     // tmp.swap(img);
 
-    auto img1 = img.ResetBorder();
     // img.SetPixel(0, 0, img.GetPixel(0, 0));
     // img.MakeBorder(3);
     // img.MakeMirrorBorder(50);
@@ -73,8 +73,7 @@ int main() {
     printf("Elapsed time (sec.): %.12f\n", sum_t / N);
 
     
-    cv::Mat i = cv::Mat(img1.rows, img1.cols, CV_8UC3, img1.data);
-    cv::imwrite("image_out.png", i);
+    imgio::WriteImage("image_out.png", img);
 
     // cv::imwrite("image01_res.jpg", i);
 
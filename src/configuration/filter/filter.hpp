@@ -1,9 +1,19 @@
 #ifndef IMAGE_PREPROCESSING_CONFIGURATION_FILTER_HPP_
 #define IMAGE_PREPROCESSING_CONFIGURATION_FILTER_HPP_
 
+#include "pp/border/border.hpp"
+#include "pp/color/color.hpp"
 #include "pp/mat/mat.hpp"
+#include "pp/mean/mean.hpp"
+#include "pp/median/median.hpp"
+#include "pp/pipeline/pipeline.hpp"
+#include "pp/planar/planar.hpp"
+#include "pp/scheduler/scheduler.hpp"
 #include "pp/transformation/transformation.hpp"
+#include "pp/window/window.hpp"
 #include <cstddef>
+#include <memory>
+#include <stdexcept>
 #include <string>
 
 namespace configuration {
@@ -17,23 +27,130 @@ std::string ValueToString(const std::string name, const T& value, const std::str
 
 }
 
+// apply() делит кадр на полосы строк между потоками OpenMP
+// (pp::ParallelDoFilter) либо, после SetThreadPool, на плитки для
+// pp::ThreadPool. Кадр без рамки (borderSize == 0) фильтруется с краями,
+// достроенными по SetBorder прямо в цикле фильтра; у кадра с рамкой она
+// отражается MakeMirrorBorder, как в ImgPP-OpenMP и ImgPP-MPI*.
 class ImageFilter {
 public:
     virtual ~ImageFilter() = default;
-    virtual pp::Mat apply(pp::Mat& img) = 0;
+    // result - изображение того же размера, что img (например, из pp::MatPool).
+    virtual void apply(pp::Mat& img, pp::Mat& result) = 0;
+    virtual void apply(pp::PlanarMat& img, pp::PlanarMat& result) = 0;
+    // Одноканальное изображение (после стадии Grayscale).
+    virtual void apply(pp::Plane& img, pp::Plane& result) = 0;
+
+    pp::Mat apply(pp::Mat& img) {
+        pp::Mat result{img.rows, img.cols, img.borderSize};
+        apply(img, result);
+
+        return result;
+    }
+
+    pp::PlanarMat apply(pp::PlanarMat& img) {
+        pp::PlanarMat result{img.rows, img.cols, img.borderSize};
+        apply(img, result);
+
+        return result;
+    }
+
+    virtual std::size_t KernelSize() const = 0;
+
+    // Тот же фильтр как стадия плиточного конвейера (pp::RunTiledPipeline).
+    virtual pp::PipelineStage Stage() const = 0;
 
     virtual std::string ToString() const = 0;
+
+    void SetThreadPool(std::shared_ptr<pp::ThreadPool> threadPool, std::size_t tileSize) {
+        threadPool_ = std::move(threadPool);
+        tileSize_ = tileSize;
+    }
+
+    void SetBorder(const pp::Border& border) {
+        border_ = border;
+    }
+
+protected:
+    template<class Image, class Processor>
+    void Dispatch(Image& img, Image& result, const Processor& proc) {
+        if (img.borderSize == 0) {
+            if (threadPool_) {
+                pp::DoFilter(img, result, proc, border_, *threadPool_, tileSize_);
+            } else {
+                pp::ParallelDoFilter(img, result, proc, border_);
+            }
+            return;
+        }
+
+        img.MakeMirrorBorder(img.borderSize);
+        if (threadPool_) {
+            pp::DoFilter(img, result, proc, *threadPool_, tileSize_);
+        } else {
+            pp::ParallelDoFilter(img, result, proc);
+        }
+    }
+
+private:
+    std::shared_ptr<pp::ThreadPool> threadPool_;
+    std::size_t tileSize_ = 0;
+    pp::Border border_;
 };
 
 class MeanFilter : public ImageFilter {
 public:
     MeanFilter(std::size_t kernelSize = 3): proc_(kernelSize) {}
 
-    pp::Mat apply(pp::Mat& img) final {
-        pp::Mat result{img.rows, img.cols, img.borderSize};
-        pp::DoFilter(img, result, proc_);
+    void apply(pp::Mat& img, pp::Mat& result) final {
+        Dispatch(img, result, proc_);
+    }
 
-        return result;
+    void apply(pp::PlanarMat& img, pp::PlanarMat& result) final {
+        Dispatch(img, result, proc_);
+    }
+
+    void apply(pp::Plane& img, pp::Plane& result) final {
+        Dispatch(img, result, proc_);
+    }
+
+    std::size_t KernelSize() const final {
+        return proc_.kernelSize;
+    }
+
+    pp::PipelineStage Stage() const final {
+        return pp::MakePipelineStage(proc_);
+    }
+
+    std::string ToString() const final {
+        return "MeanFilter(" + ValueToString("kernelSize", proc_.kernelSize) + ")";
+    }
+
+private:
+    pp::BoxMeanFilterProc proc_;
+};
+
+// Тот же MeanFilter для K = 3, 5, 7 с окном, развёрнутым на этапе компиляции.
+template<std::size_t K>
+class FixedMeanFilter : public ImageFilter {
+public:
+    void apply(pp::Mat& img, pp::Mat& result) final {
+        Dispatch(img, result, proc_);
+    }
+
+    void apply(pp::PlanarMat& img, pp::PlanarMat& result) final {
+        Dispatch(img, result, proc_);
+    }
+
+    void apply(pp::Plane& img, pp::Plane& result) final {
+        Dispatch(img, result, proc_);
+    }
+
+    std::size_t KernelSize() const final {
+        return K;
+    }
+
+    pp::PipelineStage Stage() const final {
+        return pp::MakePipelineStage(proc_);
     }
 
     std::string ToString() const final {
@@ -41,19 +158,39 @@ public:
     }
 
 private:
-    pp::MeanFilterProc proc_;
+    pp::FixedMeanFilterProc<K> proc_;
 };
 
 
 class MedianFilter : public ImageFilter {
 public:
-    MedianFilter(std::size_t kernelSize = 3): proc_(kernelSize) {}
+    MedianFilter(std::size_t kernelSize = 3): proc_(kernelSize), histogramProc_(kernelSize) {}
 
-    pp::Mat apply(pp::Mat& img) final {
-        pp::Mat result{img.rows, img.cols, img.borderSize};
-        pp::DoFilter(img, result, proc_);
+    void apply(pp::Mat& img, pp::Mat& result) final {
+        if (proc_.kernelSize >= pp::kHistogramMedianMinKernelSize) {
+            Dispatch(img, result, histogramProc_);
+        } else {
+            Dispatch(img, result, proc_);
+        }
+    }
 
-        return result;
+    void apply(pp::PlanarMat& img, pp::PlanarMat& result) final {
+        Dispatch(img, result, histogramProc_);
+    }
+
+    void apply(pp::Plane& img, pp::Plane& result) final {
+        Dispatch(img, result, histogramProc_);
+    }
+
+    std::size_t KernelSize() const final {
+        return proc_.kernelSize;
+    }
+
+    pp::PipelineStage Stage() const final {
+        if (proc_.kernelSize >= pp::kHistogramMedianMinKernelSize) {
+            return pp::MakePipelineStage(histogramProc_);
+        }
+        return pp::MakePipelineStage(proc_);
     }
 
     std::string ToString() const final {
@@ -62,15 +199,60 @@ public:
 
 private:
     pp::MedianFilterProc proc_;
+    pp::HistogramMedianFilterProc histogramProc_;
+};
+
+template<std::size_t K>
+class NetworkMedianFilter : public ImageFilter {
+public:
+    void apply(pp::Mat& img, pp::Mat& result) final {
+        Dispatch(img, result, proc_);
+    }
+
+    void apply(pp::PlanarMat& img, pp::PlanarMat& result) final {
+        Dispatch(img, result, proc_);
+    }
+
+    void apply(pp::Plane& img, pp::Plane& result) final {
+        Dispatch(img, result, proc_);
+    }
+
+    std::size_t KernelSize() const final {
+        return K;
+    }
+
+    pp::PipelineStage Stage() const final {
+        return pp::MakePipelineStage(proc_);
+    }
+
+    std::string ToString() const final {
+        return "MedianFilter(" + ValueToString("kernelSize", proc_.kernelSize) + ")";
+    }
+
+private:
+    pp::NetworkMedianFilterProc<K> proc_;
 };
 
 class SobelFilter : public ImageFilter {
 public:
-    pp::Mat apply(pp::Mat& img) final {
-        pp::Mat result{img.rows, img.cols, img.borderSize};
-        pp::DoFilter(img, result, proc_);
+    void apply(pp::Mat& img, pp::Mat& result) final {
+        Dispatch(img, result, proc_);
+    }
 
-        return result;
+    void apply(pp::PlanarMat& img, pp::PlanarMat& result) final {
+        Dispatch(img, result, proc_);
+    }
+
+    void apply(pp::Plane& img, pp::Plane& result) final {
+        Dispatch(img, result, proc_);
+    }
+
+    std::size_t KernelSize() const final {
+        return proc_.kernelSize;
+    }
+
+    pp::PipelineStage Stage() const final {
+        return pp::MakePipelineStage(proc_);
     }
 
     std::string ToString() const final {
@@ -82,11 +264,24 @@ private:
 
 class PrewittFilter : public ImageFilter {
 public:
-    pp::Mat apply(pp::Mat& img) final {
-        pp::Mat result{img.rows, img.cols, img.borderSize};
-        pp::DoFilter(img, result, proc_);
+    void apply(pp::Mat& img, pp::Mat& result) final {
+        Dispatch(img, result, proc_);
+    }
 
-        return result;
+    void apply(pp::PlanarMat& img, pp::PlanarMat& result) final {
+        Dispatch(img, result, proc_);
+    }
+
+    void apply(pp::Plane& img, pp::Plane& result) final {
+        Dispatch(img, result, proc_);
+    }
+
+    std::size_t KernelSize() const final {
+        return proc_.kernelSize;
+    }
+
+    pp::PipelineStage Stage() const final {
+        return pp::MakePipelineStage(proc_);
     }
 
     std::string ToString() const final {
@@ -101,11 +296,24 @@ public:
     ThresholdFilter(uint8_t thresholdValue)
     : proc_(thresholdValue) {}
 
-    pp::Mat apply(pp::Mat& img) final {
-        pp::Mat result{img.rows, img.cols, img.borderSize};
-        pp::DoFilter(img, result, proc_);
+    void apply(pp::Mat& img, pp::Mat& result) final {
+        Dispatch(img, result, proc_);
+    }
 
-        return result;
+    void apply(pp::PlanarMat& img, pp::PlanarMat& result) final {
+        Dispatch(img, result, proc_);
+    }
+
+    void apply(pp::Plane& img, pp::Plane& result) final {
+        Dispatch(img, result, proc_);
+    }
+
+    std::size_t KernelSize() const final {
+        return 1;
+    }
+
+    pp::PipelineStage Stage() const final {
+        return pp::MakePipelineStage(proc_);
     }
 
     std::string ToString() const final {
@@ -116,6 +324,41 @@ private:
     pp::ThresholdFilterProc proc_;
 };
 
+// Перевод каналов в HSV/HSI или обратно ("RgbToHsv", "HsvToRgb",
+// "RgbToHsi", "HsiToRgb"); следующие стадии работают с каналами H, S, V/I.
+class ColorConversionFilter : public ImageFilter {
+public:
+    ColorConversionFilter(pp::ColorConversion conversion)
+    : proc_(conversion) {}
+
+    void apply(pp::Mat& img, pp::Mat& result) final {
+        Dispatch(img, result, proc_);
+    }
+
+    void apply(pp::PlanarMat& img, pp::PlanarMat& result) final {
+        Dispatch(img, result, proc_);
+    }
+
+    void apply(pp::Plane&, pp::Plane&) final {
+        throw std::runtime_error(pp::ToString(proc_.conversion) + " needs a three-channel image");
+    }
+
+    std::size_t KernelSize() const final {
+        return 1;
+    }
+
+    pp::PipelineStage Stage() const final {
+        return pp::MakePipelineStage(proc_);
+    }
+
+    std::string ToString() const final {
+        return "ColorConversion(" + pp::ToString(proc_.conversion) + ")";
+    }
+
+private:
+    pp::ColorConversionProc proc_;
+};
+
 }
 
 #endif
\ No newline at end of file
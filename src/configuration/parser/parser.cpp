@@ -19,31 +19,202 @@ FilterPipelineParams parse(nlohmann::json& json) {
     result.in = json.value("in", "in.png");
     result.out = json.value("out", "out.png");
 
+    const std::string layout = json.value("layout", "interleaved");
+    if (layout == "planar") {
+        result.planar = true;
+    } else if (layout != "interleaved") {
+        throw std::runtime_error("Unknown layout: " + layout);
+    }
+
+    const int tileSize = json.value("tile_size", 0);
+    if (tileSize < 0) {
+        throw std::runtime_error("tile_size must be non-negative");
+    }
+    result.tileSize = tileSize;
+    if (result.tileSize > 0 && result.planar) {
+        throw std::runtime_error("tile_size is supported only for the interleaved layout");
+    }
+
+    const int stripHeight = json.value("strip_height", 0);
+    if (stripHeight < 0) {
+        throw std::runtime_error("strip_height must be non-negative");
+    }
+    result.stripHeight = stripHeight;
+    if (result.stripHeight > 0 && (result.planar || result.tileSize > 0)) {
+        throw std::runtime_error("strip_height is supported only for the interleaved layout without tile_size");
+    }
+
+    if (json.contains("batch")) {
+        const auto& batch = json.at("batch");
+        result.batch.input = batch.at("input").get<std::string>();
+        result.batch.outputDir = batch.value("output_dir", "out");
+        result.batch.format = batch.value("format", "");
+        const int decodeThreads = batch.value("decode_threads", 2);
+        const int computeThreads = batch.value("compute_threads", 1);
+        const int encodeThreads = batch.value("encode_threads", 2);
+        const int queueSize = batch.value("queue_size", 4);
+        if (result.batch.input.empty() || decodeThreads <= 0 || computeThreads <= 0 ||
+            encodeThreads <= 0 || queueSize <= 0) {
+            throw std::runtime_error("batch input must be set and thread counts and queue_size must be positive");
+        }
+        result.batch.decodeThreads = decodeThreads;
+        result.batch.computeThreads = computeThreads;
+        result.batch.encodeThreads = encodeThreads;
+        result.batch.queueSize = queueSize;
+        if (result.stripHeight > 0) {
+            throw std::runtime_error("batch is not supported with strip_height");
+        }
+    }
+
+    if (json.contains("scheduler")) {
+        const auto& scheduler = json.at("scheduler");
+        const std::string type = scheduler.value("type", "openmp");
+        if (type == "work_stealing") {
+            const int numThreads = scheduler.value("num_threads", result.numThreads);
+            const int tileSize = scheduler.value("tile_size", 64);
+            if (numThreads <= 0 || tileSize <= 0) {
+                throw std::runtime_error("scheduler num_threads and tile_size must be positive");
+            }
+            result.threadPool = std::make_shared<pp::ThreadPool>(numThreads);
+            result.schedulerTileSize = tileSize;
+        } else if (type != "openmp") {
+            throw std::runtime_error("Unknown scheduler: " + type);
+        }
+    }
+
+    if (json.contains("border")) {
+        const auto& border = json.at("border");
+        const std::string type = border.value("type", "reflect");
+        try {
+            result.border.mode = pp::ParseBorderMode(type);
+        } catch (const std::invalid_argument&) {
+            throw std::runtime_error("Unknown border: " + type);
+        }
+        const int value = border.value("value", 0);
+        if (value < 0 || value > 255) {
+            throw std::runtime_error("border value must be in [0, 255]");
+        }
+        result.border.value = value;
+    }
+    if (result.tileSize > 0 && result.border.mode != pp::BorderMode::kReflect) {
+        throw std::runtime_error("tile_size supports only the reflect border");
+    }
+    if (result.stripHeight > 0 && result.border.mode == pp::BorderMode::kWrap) {
+        throw std::runtime_error("strip_height does not support the wrap border");
+    }
+
+    if (json.contains("affinity")) {
+        const auto& affinity = json.at("affinity");
+        const std::string bind = affinity.value("bind", "none");
+        try {
+            result.binding = pp::ParseThreadBinding(bind);
+        } catch (const std::invalid_argument&) {
+            throw std::runtime_error("Unknown affinity bind: " + bind);
+        }
+        result.firstTouch = affinity.value("first_touch", false);
+    }
+    if (result.binding != pp::ThreadBinding::kNone && result.batch.enabled()) {
+        throw std::runtime_error("affinity bind is not supported with batch");
+    }
+    if (result.firstTouch && (result.planar || result.stripHeight > 0)) {
+        throw std::runtime_error("affinity first_touch is supported only for the interleaved layout without strip_height");
+    }
+
+    // Набор инструкций для пиксельных ядер; "auto" - лучший доступный
+    // (или заданный переменной PP_CPU_LEVEL).
+    const std::string cpuLevel = json.value("cpu_level", "auto");
+    if (cpuLevel == "auto") {
+        pp::ResetCpuLevel();
+    } else {
+        try {
+            pp::ForceCpuLevel(pp::ParseCpuLevel(cpuLevel));
+        } catch (const std::invalid_argument&) {
+            throw std::runtime_error("Unknown cpu_level: " + cpuLevel);
+        }
+    }
+
     for (const auto& filterConfig : json.at("filters")) {
         const std::string type = filterConfig.at("type").get<std::string>();
+        // Фильтры после "Grayscale" работают с одноканальной яркостью.
+        auto& filters = result.grayscale ? result.grayFilters : result.filters;
             
-            if (type == "Sobel") {
-                result.filters.push_back(std::make_unique<SobelFilter>());
+            if (type == "Grayscale") {
+                if (result.grayscale) {
+                    throw std::runtime_error("Grayscale may appear only once");
+                }
+                result.grayscale = true;
+            }
+            else if (type == "Sobel") {
+                filters.push_back(std::make_unique<SobelFilter>());
             }
             else if (type == "Prewitt") {
-                result.filters.push_back(std::make_unique<PrewittFilter>());
+                filters.push_back(std::make_unique<PrewittFilter>());
             }
             else if (type == "Threshold") {
                 const int threshold = filterConfig.value("threshold", 128);
-                result.filters.push_back(std::make_unique<ThresholdFilter>(threshold));
+                filters.push_back(std::make_unique<ThresholdFilter>(threshold));
             }
             else if (type == "Mean") {
                 const int kernelSize = filterConfig.value("kernel_size", 3);
-                result.filters.push_back(std::make_unique<MeanFilter>(kernelSize));
+                if (kernelSize == 3) {
+                    filters.push_back(std::make_unique<FixedMeanFilter<3>>());
+                } else if (kernelSize == 5) {
+                    filters.push_back(std::make_unique<FixedMeanFilter<5>>());
+                } else if (kernelSize == 7) {
+                    filters.push_back(std::make_unique<FixedMeanFilter<7>>());
+                } else {
+                    filters.push_back(std::make_unique<MeanFilter>(kernelSize));
+                }
             }
             else if (type == "Median") {
                 const int kernelSize = filterConfig.value("kernel_size", 3);
-                result.filters.push_back(std::make_unique<MedianFilter>(kernelSize));
+                if (kernelSize == 3) {
+                    filters.push_back(std::make_unique<NetworkMedianFilter<3>>());
+                } else if (kernelSize == 5) {
+                    filters.push_back(std::make_unique<NetworkMedianFilter<5>>());
+                } else {
+                    filters.push_back(std::make_unique<MedianFilter>(kernelSize));
+                }
+            }
+            else if (result.grayscale && type.find("Rgb") != std::string::npos) {
+                throw std::runtime_error(type + " cannot follow Grayscale");
+            }
+            else if (type == "RgbToHsv") {
+                filters.push_back(std::make_unique<ColorConversionFilter>(pp::ColorConversion::kRgbToHsv));
+            }
+            else if (type == "HsvToRgb") {
+                filters.push_back(std::make_unique<ColorConversionFilter>(pp::ColorConversion::kHsvToRgb));
+            }
+            else if (type == "RgbToHsi") {
+                filters.push_back(std::make_unique<ColorConversionFilter>(pp::ColorConversion::kRgbToHsi));
+            }
+            else if (type == "HsiToRgb") {
+                filters.push_back(std::make_unique<ColorConversionFilter>(pp::ColorConversion::kHsiToRgb));
             }
             else {
                 throw std::runtime_error("Unknown filter type: " + type);
             }
     }
+
+    if (result.grayscale && (result.tileSize > 0 || result.stripHeight > 0)) {
+        throw std::runtime_error("tile_size and strip_height are not supported with Grayscale");
+    }
+
+    for (auto& filter: result.filters) {
+        filter->SetBorder(result.border);
+    }
+    for (auto& filter: result.grayFilters) {
+        filter->SetBorder(result.border);
+    }
+
+    if (result.threadPool) {
+        for (auto& filter: result.filters) {
+            filter->SetThreadPool(result.threadPool, result.schedulerTileSize);
+        }
+        for (auto& filter: result.grayFilters) {
+            filter->SetThreadPool(result.threadPool, result.schedulerTileSize);
+        }
+    }
     
     return result;
 }
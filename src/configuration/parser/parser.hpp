@@ -4,12 +4,16 @@
 
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <vector>
 #include <memory>
 
 #include "configuration/filter/filter.hpp"
+#include "pp/affinity/affinity.hpp"
+#include "pp/gradient/gradient.hpp"
+#include "pp/cpu/cpu.hpp"
 
 
 
@@ -17,11 +21,166 @@ namespace configuration {
 
 using ImageFilterPtr = std::unique_ptr<ImageFilter>;
 
+// Кадры берутся из input: каталога (все изображения в нём), шаблона
+// имени файла с * и ? ("frames/*.png") или списка путей по одному на
+// строку. Результаты пишутся в outputDir под тем же именем; format
+// (например, ".ppraw") заменяет расширение. Декодирование, фильтры и
+// кодирование идут в своих потоках, между стадиями - очереди на
+// queueSize кадров.
+struct BatchParams {
+    std::string input;
+    std::string outputDir;
+    std::string format;
+    std::size_t decodeThreads = 2;
+    std::size_t computeThreads = 1;
+    std::size_t encodeThreads = 2;
+    std::size_t queueSize = 4;
+
+    bool enabled() const {
+        return !input.empty();
+    }
+};
+
 struct FilterPipelineParams {
     std::vector<ImageFilterPtr> filters;
+    // Стадия "Grayscale": после filters кадр переводится в одноканальную
+    // яркость (pp::Plane), и дальше работают grayFilters.
+    bool grayscale = false;
+    std::vector<ImageFilterPtr> grayFilters;
     int numThreads = 1;
     std::string in;
     std::string out;
+    // Весь конвейер работает на PlanarMat: одно разделение на плоскости
+    // в начале и одна сборка в конце.
+    bool planar = false;
+    // Сторона плитки для слитного выполнения всех фильтров
+    // (pp::RunTiledPipeline); 0 - фильтры применяются по очереди к кадру.
+    std::size_t tileSize = 0;
+    // Высота полосы для потокового режима: кадр (PPM) читается, фильтруется
+    // (pp::StripPipeline) и пишется полосами; 0 - кадр целиком в памяти.
+    std::size_t stripHeight = 0;
+    // Пул с кражей задач для фильтров ("scheduler": {"type": "work_stealing"});
+    // nullptr - полосы строк OpenMP.
+    std::shared_ptr<pp::ThreadPool> threadPool;
+    std::size_t schedulerTileSize = 0;
+    // Пакетный режим ("batch"): много кадров за один запуск.
+    BatchParams batch;
+    // Достраивание краёв кадра без рамки ("border": {"type": "reflect"}).
+    pp::Border border;
+    // "affinity": {"bind": "spread", "first_touch": true} - потоки OpenMP
+    // закрепляются за ядрами (pp::BindThreads), а кадр и промежуточные
+    // буферы размещаются первым касанием полосами строк этих потоков.
+    pp::ThreadBinding binding = pp::ThreadBinding::kNone;
+    bool firstTouch = false;
+
+    pp::Mat::Placement Placement() const {
+        return firstTouch ? pp::Mat::Placement::kFirstTouch : pp::Mat::Placement::kDefault;
+    }
+
+    // Рамка, достаточная для окна любого из фильтров, если кадр хранится
+    // с физической рамкой (кадр без рамки фильтры достраивают сами).
+    std::size_t BorderSize() const {
+        std::size_t borderSize = 0;
+        for (const auto& filter: filters) {
+            borderSize = std::max(borderSize, filter->KernelSize() / 2);
+        }
+        for (const auto& filter: grayFilters) {
+            borderSize = std::max(borderSize, filter->KernelSize() / 2);
+        }
+        return borderSize;
+    }
+
+    // Суммарный радиус окон filters: столько строк и столбцов нужно кадру
+    // для слитного выполнения по плиткам.
+    std::size_t TotalRadius() const {
+        std::size_t radius = 0;
+        for (const auto& filter: filters) {
+            radius += filter->KernelSize() / 2;
+        }
+        return radius;
+    }
+
+    std::vector<pp::PipelineStage> Stages() const {
+        std::vector<pp::PipelineStage> stages;
+        for (const auto& filter: filters) {
+            stages.push_back(filter->Stage());
+        }
+        return stages;
+    }
+
+    // Применяет фильтры к img (interleaved). Промежуточные буферы берутся из
+    // pool и возвращаются туда же, поэтому для кадров одного размера после
+    // первого вызова полноразмерные буферы не выделяются. Кадр меньше
+    // суммарного радиуса окон обрабатывается по стадиям, а не по плиткам.
+    void apply(pp::Mat& img, pp::MatPool& pool) const {
+        // Декодированный кадр записан одним потоком; копия в буфер из pool
+        // раскладывает его полосы по узлам потоков, которые их фильтруют.
+        // Сам кадр в pool не возвращается (следующий кадр получил бы его
+        // как размещённый буфер) и освобождается, только когда оба буфера
+        // конвейера уже взяты, чтобы новый буфер не занял его страницы.
+        pp::Mat decoded;
+        if (firstTouch) {
+            pp::Mat placed = pool.Acquire(img.rows, img.cols, img.borderSize, Placement());
+            pp::CopyRowStrips(img, placed);
+            decoded.swap(img);
+            img.swap(placed);
+        }
+        pp::Mat tmp = pool.Acquire(img.rows, img.cols, img.borderSize, Placement());
+        pp::Mat().swap(decoded);
+        const std::size_t radius = TotalRadius();
+        if (tileSize > 0 && radius <= img.rows - 2 * img.borderSize && radius <= img.cols - 2 * img.borderSize) {
+            pp::RunTiledPipeline(img, tmp, Stages(), tileSize, pool);
+            img.swap(tmp);
+        } else {
+            for (const auto& filter: filters) {
+                filter->apply(img, tmp);
+                img.swap(tmp);
+            }
+        }
+        pool.Release(std::move(tmp));
+    }
+
+    // Переводит результат filters в яркость gray (той же рамки) и применяет
+    // к нему grayFilters. Буфер gray переиспользуется, если размер тот же,
+    // промежуточный берётся из pool.
+    template<class Image>
+    void applyGray(const Image& img, pp::Plane& gray, pp::MatPool& pool) const {
+        pp::Grayscale(img, gray);
+
+        pp::Plane tmp = pool.AcquirePlane(gray.rows, gray.cols, gray.borderSize);
+        for (const auto& filter: grayFilters) {
+            filter->apply(gray, tmp);
+            gray.swap(tmp);
+        }
+        pool.Release(std::move(tmp));
+    }
+
+    // Весь конвейер для одного кадра: filters в выбранной раскладке, затем
+    // стадия Grayscale. Результат - в img или, если grayscale, в gray.
+    // Плоскости для planar, как и буферы Mat, берутся из pool.
+    void process(pp::Mat& img, pp::Plane& gray, pp::MatPool& pool) const {
+        if (planar) {
+            pp::PlanarMat planarImg = pool.AcquirePlanar(img.rows, img.cols, img.borderSize);
+            pp::PlanarMat tmp = pool.AcquirePlanar(img.rows, img.cols, img.borderSize);
+            pp::Deinterleave(img, planarImg);
+            for (const auto& filter: filters) {
+                filter->apply(planarImg, tmp);
+                planarImg.swap(tmp);
+            }
+            if (grayscale) {
+                applyGray(planarImg, gray, pool);
+            } else {
+                pp::Interleave(planarImg, img);
+            }
+            pool.Release(std::move(planarImg));
+            pool.Release(std::move(tmp));
+        } else {
+            apply(img, pool);
+            if (grayscale) {
+                applyGray(img, gray, pool);
+            }
+        }
+    }
 
     void log() {
 
@@ -32,11 +191,37 @@ struct FilterPipelineParams {
         if (!filters.empty()) {
             filtersInfo += filters[filters.size() - 1]->ToString();
         }
+        if (grayscale) {
+            filtersInfo += filters.empty() ? "Grayscale" : ",Grayscale";
+            for (const auto& filter: grayFilters) {
+                filtersInfo += "," + filter->ToString();
+            }
+        }
 
         std::cout << "FilterPipelineParams:\n" 
             << "\tnumThreads=" + std::to_string(numThreads) << "\n" 
             << "\tin=" + in << "\n" 
             << "\tout=" + out << "\n" 
+            << "\tlayout=" + std::string(planar ? "planar" : "interleaved") << "\n" 
+            << "\ttileSize=" + std::to_string(tileSize) << "\n" 
+            << "\tstripHeight=" + std::to_string(stripHeight) << "\n" 
+            << "\tbatch=" + (batch.enabled()
+                ? "(input=" + batch.input + ",outputDir=" + batch.outputDir
+                    + ",decodeThreads=" + std::to_string(batch.decodeThreads)
+                    + ",computeThreads=" + std::to_string(batch.computeThreads)
+                    + ",encodeThreads=" + std::to_string(batch.encodeThreads)
+                    + ",queueSize=" + std::to_string(batch.queueSize) + ")"
+                : std::string("off")) << "\n" 
+            << "\tscheduler=" + (threadPool
+                ? "work_stealing(numThreads=" + std::to_string(threadPool->NumThreads())
+                    + ",tileSize=" + std::to_string(schedulerTileSize) + ")"
+                : std::string("openmp")) << "\n" 
+            << "\tborder=" + pp::ToString(border.mode)
+                + (border.mode == pp::BorderMode::kConstant
+                    ? "(value=" + std::to_string(border.value) + ")"
+                    : std::string()) << "\n" 
+            << "\taffinity=" + pp::ToString(binding) + (firstTouch ? "(first_touch)" : "") << "\n" 
+            << "\tcpuLevel=" + pp::ToString(pp::ActiveCpuLevel()) << "\n" 
             << "\tfilters=" + filtersInfo << "\n\n"; 
     }
 
@@ -0,0 +1,104 @@
+#include "distributed/distributed.hpp"
+
+#include <climits>
+#include <stdexcept>
+#include <string>
+
+namespace distributed {
+namespace {
+
+constexpr int kPixelSize = 3; // r-g-b
+
+// Собственные пиксели блока local (без ghost-ячеек) и их место в строках
+// кадра .ppraw с заголовком header; (rowOff, colOff) - левый верхний пиксель
+// блока в кадре.
+void MakeBlockTypes(const pp::RawHeader& header, const pp::Mat& local,
+                    std::size_t rowOff, std::size_t colOff,
+                    MPI_Datatype& fileType, MPI_Datatype& memType)
+{
+    const std::size_t b = local.borderSize;
+
+    const int blockSizes[2] = {static_cast<int>(local.rows - 2*b),
+                               static_cast<int>((local.cols - 2*b) * kPixelSize)};
+
+    const int fileSizes[2]  = {static_cast<int>(header.rows), static_cast<int>(header.step)};
+    const int fileStarts[2] = {static_cast<int>(rowOff), static_cast<int>(colOff * kPixelSize)};
+    MPI_Type_create_subarray(2, fileSizes, blockSizes, fileStarts, MPI_ORDER_C, MPI_UINT8_T, &fileType);
+    MPI_Type_commit(&fileType);
+
+    const int memSizes[2]  = {static_cast<int>(local.rows), static_cast<int>(local.step)};
+    const int memStarts[2] = {static_cast<int>(b), static_cast<int>(b * kPixelSize)};
+    MPI_Type_create_subarray(2, memSizes, blockSizes, memStarts, MPI_ORDER_C, MPI_UINT8_T, &memType);
+    MPI_Type_commit(&memType);
+}
+
+} // namespace
+
+pp::RawHeader OpenRawImage(const char* path, MPI_File& file)
+{
+    if (MPI_File_open(MPI_COMM_WORLD, path, MPI_MODE_RDONLY, MPI_INFO_NULL, &file) != MPI_SUCCESS) {
+        throw std::runtime_error("Cannot open raw image: " + std::string(path));
+    }
+
+    pp::RawHeader header{};
+    MPI_Offset fileSize = 0;
+    MPI_File_read_at_all(file, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE);
+    MPI_File_get_size(file, &fileSize);
+
+    try {
+        pp::CheckRawHeader(header, fileSize, path);
+        // Размеры подмассивов MPI - int.
+        if (header.rows > INT_MAX || header.step > INT_MAX) {
+            throw std::runtime_error("Raw image is too large for MPI-IO: " + std::string(path));
+        }
+    } catch (...) {
+        MPI_File_close(&file);
+        throw;
+    }
+
+    return header;
+}
+
+void ReadBlock(MPI_File file, const pp::RawHeader& header, pp::Mat& local,
+               std::size_t rowOff, std::size_t colOff)
+{
+    MPI_Datatype fileType, memType;
+    MakeBlockTypes(header, local, rowOff, colOff, fileType, memType);
+
+    MPI_File_set_view(file, header.dataOffset, MPI_UINT8_T, fileType, "native", MPI_INFO_NULL);
+    MPI_File_read_all(file, local.GetPtr(0, 0), 1, memType, MPI_STATUS_IGNORE);
+
+    MPI_Type_free(&fileType);
+    MPI_Type_free(&memType);
+}
+
+void WriteBlock(const char* path, const pp::RawHeader& header, const pp::Mat& local,
+                std::size_t rowOff, std::size_t colOff)
+{
+    MPI_File file;
+    if (MPI_File_open(MPI_COMM_WORLD, path, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &file) != MPI_SUCCESS) {
+        throw std::runtime_error("Cannot write raw image: " + std::string(path));
+    }
+
+    // Старое содержимое отбрасывается; выравнивание строк остаётся нулевым.
+    MPI_File_set_size(file, 0);
+    MPI_File_set_size(file, header.dataOffset + header.rows * header.step);
+
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    if (rank == 0) {
+        MPI_File_write_at(file, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE);
+    }
+
+    MPI_Datatype fileType, memType;
+    MakeBlockTypes(header, local, rowOff, colOff, fileType, memType);
+
+    MPI_File_set_view(file, header.dataOffset, MPI_UINT8_T, fileType, "native", MPI_INFO_NULL);
+    MPI_File_write_all(file, local.GetPtr(0, 0), 1, memType, MPI_STATUS_IGNORE);
+
+    MPI_Type_free(&fileType);
+    MPI_Type_free(&memType);
+    MPI_File_close(&file);
+}
+
+} // namespace distributed
@@ -0,0 +1,47 @@
+#ifndef IMAGE_PREPROCESSING_DISTRIBUTED_HPP_
+#define IMAGE_PREPROCESSING_DISTRIBUTED_HPP_
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <cstddef>
+
+#include "pp/mat/mat.hpp"
+#include "pp/raw/raw.hpp"
+
+// Общее для драйверов ImgPP-MPI1D и ImgPP-MPI2D: разбиение окон блока для
+// перекрытия обмена с вычислениями и чтение/запись блоков кадра .ppraw
+// через MPI-IO.
+namespace distributed {
+
+// Окна [begin, end) по одной оси: первым half окнам нужны ghost-ячейки
+// с одной стороны, последним half - с другой, окнам [innerBegin, innerEnd)
+// ghost-ячейки не нужны.
+struct Bands {
+    std::size_t begin, innerBegin, innerEnd, end;
+};
+
+inline Bands SplitWindows(std::size_t begin, std::size_t count, std::size_t half)
+{
+    const std::size_t head = std::min(half, count);
+    const std::size_t tail = std::min(half, count - head);
+    return Bands{begin, begin + head, begin + count - tail, begin + count};
+}
+
+// Открывает кадр .ppraw (pp::RawHeader) на всех рангах и читает заголовок.
+// Ошибки - std::runtime_error, одинаково на всех рангах.
+pp::RawHeader OpenRawImage(const char* path, MPI_File& file);
+
+// Каждый ранг читает из file только свой блок - в собственные пиксели local
+// (без ghost-ячеек); (rowOff, colOff) - левый верхний пиксель блока в кадре.
+void ReadBlock(MPI_File file, const pp::RawHeader& header, pp::Mat& local,
+               std::size_t rowOff, std::size_t colOff);
+
+// Собирает кадр в файле path коллективной записью: заголовок пишет ранг 0,
+// собственные пиксели local - каждый ранг на своё место.
+void WriteBlock(const char* path, const pp::RawHeader& header, const pp::Mat& local,
+                std::size_t rowOff, std::size_t colOff);
+
+} // namespace distributed
+
+#endif
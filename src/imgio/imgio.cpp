@@ -0,0 +1,252 @@
+#include "imgio/imgio.hpp"
+#include "pp/raw/raw.hpp"
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace imgio {
+namespace {
+
+struct Size {
+    std::size_t rows = 0;
+    std::size_t cols = 0;
+};
+
+uint32_t ReadBigEndian(const std::vector<uchar>& buf, std::size_t pos, std::size_t bytes) {
+    uint32_t value = 0;
+    for (std::size_t i = 0; i < bytes; ++i) {
+        value = (value << 8) | buf[pos + i];
+    }
+    return value;
+}
+
+bool ProbePng(const std::vector<uchar>& buf, Size& size) {
+    static const uchar kSignature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+    if (buf.size() < 24 || std::memcmp(buf.data(), kSignature, sizeof(kSignature)) != 0 ||
+        std::memcmp(buf.data() + 12, "IHDR", 4) != 0) {
+        return false;
+    }
+
+    size.cols = ReadBigEndian(buf, 16, 4);
+    size.rows = ReadBigEndian(buf, 20, 4);
+    return true;
+}
+
+bool ProbeJpeg(const std::vector<uchar>& buf, Size& size) {
+    if (buf.size() < 4 || buf[0] != 0xFF || buf[1] != 0xD8) {
+        return false;
+    }
+
+    std::size_t pos = 2;
+    while (pos + 4 <= buf.size()) {
+        if (buf[pos] != 0xFF) {
+            return false;
+        }
+
+        const uchar marker = buf[pos + 1];
+        if (marker == 0xFF) {
+            ++pos;
+            continue;
+        }
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD9)) {
+            pos += 2;
+            continue;
+        }
+
+        const std::size_t length = ReadBigEndian(buf, pos + 2, 2);
+        // SOF0..SOF15, кроме DHT (C4), JPG (C8) и DAC (CC).
+        const bool isFrame = marker >= 0xC0 && marker <= 0xCF &&
+                             marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+        if (isFrame) {
+            if (pos + 9 > buf.size()) {
+                return false;
+            }
+            size.rows = ReadBigEndian(buf, pos + 5, 2);
+            size.cols = ReadBigEndian(buf, pos + 7, 2);
+            return true;
+        }
+
+        pos += 2 + length;
+    }
+
+    return false;
+}
+
+pp::Mat CopyToMat(const cv::Mat& img) {
+    pp::Mat result(img.rows, img.cols);
+
+    for (int row = 0; row < img.rows; ++row) {
+        std::memcpy(result.GetPtr(row, 0), img.ptr<uchar>(row), img.cols * 3);
+    }
+
+    return result;
+}
+
+// Следующее число заголовка PNM; комментарии (#...) пропускаются.
+std::size_t ReadPnmValue(std::istream& in, const std::string& path) {
+    while (true) {
+        const int c = in.peek();
+        if (c == '#') {
+            in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        } else if (std::isspace(c)) {
+            in.get();
+        } else {
+            break;
+        }
+    }
+
+    std::size_t value = 0;
+    if (!(in >> value)) {
+        throw std::runtime_error("Bad PPM header: " + path);
+    }
+    return value;
+}
+
+bool HasRawExtension(const std::string& path) {
+    const std::string extension = pp::kRawExtension;
+    return path.size() >= extension.size() &&
+           path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+// PPM хранит RGB, а пиксели в памяти - BGR.
+void SwapRedBlue(uint8_t* row, std::size_t cols) {
+    for (std::size_t j = 0; j < cols; ++j) {
+        std::swap(row[j * 3], row[j * 3 + 2]);
+    }
+}
+
+} // namespace
+
+pp::Mat ReadImage(const std::string& path) {
+    if (pp::IsRawImage(path)) {
+        return pp::MapRawImage(path, pp::MapMode::kCopyOnWrite);
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open image: " + path);
+    }
+    const std::vector<uchar> buf{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+
+    Size size;
+    if (ProbePng(buf, size) || ProbeJpeg(buf, size)) {
+        pp::Mat result(size.rows, size.cols);
+
+        // Заголовок cv::Mat поверх буфера Mat: create() внутри imdecode при
+        // совпадении размера и типа память не перевыделяет.
+        cv::Mat view(size.rows, size.cols, CV_8UC3, result.GetPtr(0, 0), result.step);
+        uchar* const target = view.data;
+
+        cv::imdecode(buf, cv::IMREAD_COLOR, &view);
+        if (view.empty()) {
+            throw std::runtime_error("Cannot decode image: " + path);
+        }
+        if (view.data == target) {
+            return result;
+        }
+
+        // Декодер выделил свой буфер (например, повернул JPEG по EXIF).
+        return CopyToMat(view);
+    }
+
+    cv::Mat decoded = cv::imdecode(buf, cv::IMREAD_COLOR);
+    if (decoded.empty()) {
+        throw std::runtime_error("Cannot decode image: " + path);
+    }
+
+    // Буфер декодера забирается как есть и отпускается вместе с Mat.
+    return pp::Mat(decoded.rows, decoded.cols, decoded.step[0], decoded.data,
+                   [decoded](uint8_t*) {});
+}
+
+bool WriteImage(const std::string& path, const pp::Mat& img) {
+    if (HasRawExtension(path)) {
+        pp::WriteRawImage(path, img);
+        return true;
+    }
+
+    const std::size_t b = img.borderSize;
+    cv::Mat interior(img.rows - 2 * b, img.cols - 2 * b, CV_8UC3,
+                     const_cast<uint8_t*>(img.GetPtr(b, b)), img.step);
+
+    return cv::imwrite(path, interior);
+}
+
+bool WriteImage(const std::string& path, const pp::Plane& img) {
+    if (HasRawExtension(path)) {
+        pp::WriteRawImage(path, img);
+        return true;
+    }
+
+    const std::size_t b = img.borderSize;
+    cv::Mat interior(img.rows - 2 * b, img.cols - 2 * b, CV_8UC1,
+                     const_cast<uint8_t*>(img.GetPtr(b, b)), img.step);
+
+    return cv::imwrite(path, interior);
+}
+
+PpmReader::PpmReader(const std::string& path): file_(path, std::ios::binary), path_(path) {
+    char magic[2] = {};
+    if (!file_.read(magic, 2)) {
+        throw std::runtime_error("Cannot open image: " + path);
+    }
+    if (magic[0] != 'P' || magic[1] != '6') {
+        throw std::runtime_error("Streaming needs a binary PPM (P6) image: " + path);
+    }
+
+    cols_ = ReadPnmValue(file_, path);
+    rows_ = ReadPnmValue(file_, path);
+    if (ReadPnmValue(file_, path) != 255) {
+        throw std::runtime_error("Only 8-bit PPM images are supported: " + path);
+    }
+    // Ровно один пробельный символ перед пикселями.
+    file_.get();
+}
+
+std::size_t PpmReader::Read(pp::Mat& strip) {
+    if (strip.cols != cols_) {
+        throw std::invalid_argument("PpmReader: strip width differs from the image width");
+    }
+
+    const std::size_t count = std::min(strip.rows, rows_ - read_);
+    for (std::size_t i = 0; i < count; ++i) {
+        uint8_t* row = strip.GetPtr(i, 0);
+        if (!file_.read(reinterpret_cast<char*>(row), cols_ * 3)) {
+            throw std::runtime_error("Unexpected end of image: " + path_);
+        }
+        SwapRedBlue(row, cols_);
+    }
+    read_ += count;
+
+    return count;
+}
+
+PpmWriter::PpmWriter(const std::string& path, std::size_t rows, std::size_t cols)
+    : file_(path, std::ios::binary), path_(path), cols_(cols), row_(cols * 3) {
+    if (!(file_ << "P6\n" << cols << " " << rows << "\n255\n")) {
+        throw std::runtime_error("Cannot write image: " + path);
+    }
+}
+
+void PpmWriter::Write(const pp::Mat& strip) {
+    for (std::size_t i = 0; i < strip.rows; ++i) {
+        std::memcpy(row_.data(), strip.GetPtr(i, 0), cols_ * 3);
+        SwapRedBlue(row_.data(), cols_);
+        if (!file_.write(reinterpret_cast<const char*>(row_.data()), row_.size())) {
+            throw std::runtime_error("Cannot write image: " + path_);
+        }
+    }
+}
+
+} // namespace imgio
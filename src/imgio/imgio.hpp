@@ -0,0 +1,68 @@
+#ifndef IMAGE_PREPROCESSING_IMGIO_HPP_
+#define IMAGE_PREPROCESSING_IMGIO_HPP_
+
+#include "pp/mat/mat.hpp"
+#include "pp/planar/planar.hpp"
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace imgio {
+
+// Декодирует изображение в Mat без рамки. Размер берётся из заголовка
+// PNG/JPEG, и OpenCV пишет пиксели прямо в буфер Mat; если декодер всё же
+// выделил свой буфер - одно построчное копирование. Для остальных форматов
+// Mat владеет буфером декодера. Файл формата pp/raw отображается в память
+// (копирование при записи) без декодирования.
+pp::Mat ReadImage(const std::string& path);
+
+// Записывает внутреннюю область img (без рамки) без промежуточных копий;
+// путь с расширением pp::kRawExtension - в формате pp/raw.
+bool WriteImage(const std::string& path, const pp::Mat& img);
+
+// То же для одноканального изображения (пишется как оттенки серого).
+bool WriteImage(const std::string& path, const pp::Plane& img);
+
+// Потоковое чтение двоичного PPM (P6, maxval 255) полосами строк, без
+// загрузки всего кадра. Каналы в памяти в порядке OpenCV (BGR), как у
+// ReadImage, поэтому фильтры дают тот же результат.
+class PpmReader {
+public:
+    explicit PpmReader(const std::string& path);
+
+    std::size_t Rows() const { return rows_; }
+    std::size_t Cols() const { return cols_; }
+
+    // Читает до strip.rows следующих строк в начало strip (strip.cols ==
+    // Cols()); возвращает число прочитанных строк, 0 - кадр закончился.
+    std::size_t Read(pp::Mat& strip);
+
+private:
+    std::ifstream file_;
+    std::string path_;
+    std::size_t rows_ = 0;
+    std::size_t cols_ = 0;
+    std::size_t read_ = 0;
+};
+
+// Потоковая запись двоичного PPM: заголовок пишется сразу, строки - по
+// мере готовности полос.
+class PpmWriter {
+public:
+    PpmWriter(const std::string& path, std::size_t rows, std::size_t cols);
+
+    // Дописывает строки strip (cols пикселей, без рамки).
+    void Write(const pp::Mat& strip);
+
+private:
+    std::ofstream file_;
+    std::string path_;
+    std::size_t cols_;
+    std::vector<uint8_t> row_;
+};
+
+} // namespace imgio
+
+#endif
@@ -0,0 +1,82 @@
+#include "pp/affinity/affinity.hpp"
+
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <vector>
+
+#include <omp.h>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace pp {
+
+#ifdef __linux__
+
+bool BindThreads(ThreadBinding binding) {
+    if (binding == ThreadBinding::kNone) {
+        return true;
+    }
+
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return false;
+    }
+    std::vector<int> cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &allowed)) {
+            cpus.push_back(cpu);
+        }
+    }
+    if (cpus.empty()) {
+        return false;
+    }
+
+    bool bound = true;
+    #pragma omp parallel reduction(&&: bound)
+    {
+        const std::size_t threads = omp_get_num_threads();
+        const std::size_t id = omp_get_thread_num();
+        const std::size_t slot = binding == ThreadBinding::kClose
+            ? id % cpus.size()
+            : id * cpus.size() / threads;
+
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpus[slot], &set);
+        // pid 0 - вызывающий поток, а не весь процесс.
+        bound = sched_setaffinity(0, sizeof(set), &set) == 0;
+    }
+
+    return bound;
+}
+
+#else
+
+bool BindThreads(ThreadBinding binding) {
+    return binding == ThreadBinding::kNone;
+}
+
+#endif
+
+std::string ToString(ThreadBinding binding) {
+    switch (binding) {
+        case ThreadBinding::kNone: return "none";
+        case ThreadBinding::kClose: return "close";
+        case ThreadBinding::kSpread: return "spread";
+    }
+    return "unknown";
+}
+
+ThreadBinding ParseThreadBinding(const std::string& name) {
+    for (ThreadBinding binding: {ThreadBinding::kNone, ThreadBinding::kClose, ThreadBinding::kSpread}) {
+        if (ToString(binding) == name) {
+            return binding;
+        }
+    }
+    throw std::invalid_argument("Unknown thread binding: " + name);
+}
+
+} // namespace pp
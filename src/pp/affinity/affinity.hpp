@@ -0,0 +1,32 @@
+#ifndef IMAGE_PREPROCESSING_PP_AFFINITY_HPP_
+#define IMAGE_PREPROCESSING_PP_AFFINITY_HPP_
+
+#include <string>
+
+namespace pp {
+
+// Привязка потоков команды OpenMP к ядрам из тех, что доступны процессу.
+enum class ThreadBinding {
+    kNone,   // решает ОС (или OMP_PROC_BIND/OMP_PLACES)
+    kClose,  // поток i - на i-е ядро: команда занимает соседние ядра
+    kSpread, // потоки равномерно по списку ядер: на двухсокетной машине -
+             // поровну на каждый сокет
+};
+
+// Привязывает каждый поток команды из omp_get_max_threads() потоков к
+// своему ядру. OpenMP переиспользует эти потоки в следующих параллельных
+// областях того же размера, поэтому привязка и первое касание страниц
+// (Mat::Placement::kFirstTouch) остаются согласованными. Вызывается вне
+// параллельных областей; false - привязка не удалась или не
+// поддерживается платформой.
+bool BindThreads(ThreadBinding binding);
+
+std::string ToString(ThreadBinding binding);
+
+// Разбирает имя привязки ("none", "close", "spread"); для неизвестного
+// имени бросает std::invalid_argument.
+ThreadBinding ParseThreadBinding(const std::string& name);
+
+} // namespace pp
+
+#endif
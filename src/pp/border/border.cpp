@@ -0,0 +1,132 @@
+#include "pp/border/border.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace pp {
+namespace {
+
+using Index = std::ptrdiff_t;
+
+Index Mod(Index i, Index n) {
+    const Index m = i % n;
+    return m < 0 ? m + n : m;
+}
+
+} // namespace
+
+std::string ToString(BorderMode mode) {
+    switch (mode) {
+        case BorderMode::kReflect: return "reflect";
+        case BorderMode::kReplicate: return "replicate";
+        case BorderMode::kConstant: return "constant";
+        case BorderMode::kWrap: return "wrap";
+    }
+    return "unknown";
+}
+
+BorderMode ParseBorderMode(const std::string& name) {
+    for (BorderMode mode: {BorderMode::kReflect, BorderMode::kReplicate, BorderMode::kConstant, BorderMode::kWrap}) {
+        if (ToString(mode) == name) {
+            return mode;
+        }
+    }
+    throw std::invalid_argument("Unknown border mode: " + name);
+}
+
+Index BorderIndex(Index i, Index size, BorderMode mode) {
+    if (i >= 0 && i < size) {
+        return i;
+    }
+
+    switch (mode) {
+        case BorderMode::kReflect: {
+            // Отражение периодично с периодом 2 * size.
+            const Index m = Mod(i, 2 * size);
+            return m < size ? m : 2 * size - 1 - m;
+        }
+        case BorderMode::kReplicate:
+            return i < 0 ? 0 : size - 1;
+        case BorderMode::kConstant:
+            return -1;
+        case BorderMode::kWrap:
+            return Mod(i, size);
+    }
+    return -1;
+}
+
+void CopyRowBordered(const uint8_t* row, Index width, Index j0, Index count,
+                     std::size_t channels, const Border& border, uint8_t* dst) {
+    const Index j1 = j0 + count;
+    const Index inner0 = std::clamp<Index>(0, j0, j1);
+    const Index inner1 = std::clamp<Index>(width, inner0, j1);
+
+    auto edge = [&](Index j) {
+        uint8_t* d = dst + (j - j0) * channels;
+        const Index src = BorderIndex(j, width, border.mode);
+        if (src < 0) {
+            std::memset(d, border.value, channels);
+        } else {
+            std::memcpy(d, row + src * channels, channels);
+        }
+    };
+
+    for (Index j = j0; j < inner0; ++j) {
+        edge(j);
+    }
+    std::memcpy(dst + (inner0 - j0) * channels, row + inner0 * channels, (inner1 - inner0) * channels);
+    for (Index j = inner1; j < j1; ++j) {
+        edge(j);
+    }
+}
+
+void GatherBordered(const Mat& src, Index y0, Index x0, const Border& border, Mat& dst) {
+    for (std::size_t i = 0; i < dst.rows; ++i) {
+        const Index row = BorderIndex(y0 + static_cast<Index>(i), src.rows, border.mode);
+        if (row < 0) {
+            std::memset(dst.GetPtr(i, 0), border.value, dst.cols * 3);
+        } else {
+            CopyRowBordered(src.GetPtr(row, 0), src.cols, x0, dst.cols, 3, border, dst.GetPtr(i, 0));
+        }
+    }
+}
+
+void GatherBordered(const Plane& src, Index y0, Index x0, const Border& border, Plane& dst) {
+    for (std::size_t i = 0; i < dst.rows; ++i) {
+        const Index row = BorderIndex(y0 + static_cast<Index>(i), src.rows, border.mode);
+        if (row < 0) {
+            std::memset(dst.GetPtr(i, 0), border.value, dst.cols);
+        } else {
+            CopyRowBordered(src.GetPtr(row, 0), src.cols, x0, dst.cols, 1, border, dst.GetPtr(i, 0));
+        }
+    }
+}
+
+void GatherBordered(const PlanarMat& src, Index y0, Index x0, const Border& border, PlanarMat& dst) {
+    for (std::size_t i = 0; i < src.planes.size(); ++i) {
+        GatherBordered(src.planes[i], y0, x0, border, dst.planes[i]);
+    }
+}
+
+void CopyBlock(const Mat& src, const Rect& rect, Mat& dst, std::size_t y, std::size_t x) {
+    for (std::size_t i = 0; i < rect.height; ++i) {
+        std::memcpy(dst.GetPtr(y + i, x), src.GetPtr(rect.y + i, rect.x), rect.width * 3);
+    }
+}
+
+void CopyBlock(const Plane& src, const Rect& rect, Plane& dst, std::size_t y, std::size_t x) {
+    for (std::size_t i = 0; i < rect.height; ++i) {
+        std::memcpy(dst.GetPtr(y + i, x), src.GetPtr(rect.y + i, rect.x), rect.width);
+    }
+}
+
+void CopyBlock(const PlanarMat& src, const Rect& rect, PlanarMat& dst, std::size_t y, std::size_t x) {
+    for (std::size_t i = 0; i < src.planes.size(); ++i) {
+        CopyBlock(src.planes[i], rect, dst.planes[i], y, x);
+    }
+}
+
+} // namespace pp
@@ -0,0 +1,137 @@
+#ifndef IMAGE_PREPROCESSING_PP_BORDER_HPP_
+#define IMAGE_PREPROCESSING_PP_BORDER_HPP_
+
+#include "pp/mat/mat.hpp"
+#include "pp/planar/planar.hpp"
+#include "pp/transformation/transformation.hpp"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace pp {
+
+// Как достраиваются пиксели за краем изображения (n - размер по оси).
+enum class BorderMode {
+    kReflect,   // cba|abc, как MakeMirrorBorder: -1 -> 0, n -> n - 1
+    kReplicate, // aaa|abc
+    kConstant,  // vvv|abc, v = Border::value во всех каналах
+    kWrap,      // xyz|abc, -1 -> n - 1
+};
+
+std::string ToString(BorderMode mode);
+
+// "reflect", "replicate", "constant", "wrap"; иначе std::invalid_argument.
+BorderMode ParseBorderMode(const std::string& name);
+
+struct Border {
+    BorderMode mode = BorderMode::kReflect;
+    uint8_t value = 0;
+};
+
+// Индекс в [0, size) для координаты i или -1, если пиксель за краем
+// берётся из Border::value (kConstant).
+std::ptrdiff_t BorderIndex(std::ptrdiff_t i, std::ptrdiff_t size, BorderMode mode);
+
+// Копирует в dst count пикселей по channels байт, начиная с j0 (может быть
+// отрицательным), из строки ширины width; выходящие за край достраиваются
+// по border.
+void CopyRowBordered(const uint8_t* row, std::ptrdiff_t width, std::ptrdiff_t j0, std::ptrdiff_t count,
+                     std::size_t channels, const Border& border, uint8_t* dst);
+
+// Заполняет весь dst окном src с левым верхним углом (y0, x0); окно может
+// выходить за края src (rows x cols целиком, borderSize не учитывается).
+void GatherBordered(const Mat& src, std::ptrdiff_t y0, std::ptrdiff_t x0, const Border& border, Mat& dst);
+void GatherBordered(const Plane& src, std::ptrdiff_t y0, std::ptrdiff_t x0, const Border& border, Plane& dst);
+void GatherBordered(const PlanarMat& src, std::ptrdiff_t y0, std::ptrdiff_t x0, const Border& border, PlanarMat& dst);
+
+// Копирует прямоугольник rect из src в dst с левым верхним углом (y, x).
+void CopyBlock(const Mat& src, const Rect& rect, Mat& dst, std::size_t y, std::size_t x);
+void CopyBlock(const Plane& src, const Rect& rect, Plane& dst, std::size_t y, std::size_t x);
+void CopyBlock(const PlanarMat& src, const Rect& rect, PlanarMat& dst, std::size_t y, std::size_t x);
+
+// Считает пиксели pixels (координаты src) по копии их окрестности,
+// собранной GatherBordered. Используется для полос у краёв кадра.
+template<class Image, class Processor>
+void DoFilterGathered(Image& src, Image& dst, const Processor& proc, const Border& border, const Rect& pixels) {
+    const std::size_t r = proc.kernelSize / 2;
+    Image window(pixels.height + 2 * r, pixels.width + 2 * r);
+    Image result(window.rows, window.cols);
+
+    GatherBordered(src, static_cast<std::ptrdiff_t>(pixels.y - r), static_cast<std::ptrdiff_t>(pixels.x - r),
+                   border, window);
+    DoFilter(window, result, proc, Rect(0, 0, pixels.width, pixels.height));
+    CopyBlock(result, Rect(r, r, pixels.width, pixels.height), dst, pixels.y, pixels.x);
+}
+
+// DoFilter без физической рамки: src и dst одного размера, rows x cols
+// целиком (borderSize не учитывается), результат пишется в пиксели pixels,
+// а пиксели за краем src достраиваются по border. Пиксели, окна которых
+// целиком внутри src, считаются обычным DoFilter прямо по src; только
+// полосы шириной kernelSize / 2 у краёв идут через DoFilterGathered.
+// Копия кадра с рамкой не создаётся. С kReflect результат совпадает
+// с MakeMirrorBorder + DoFilter по кадру с рамкой.
+// Image - Mat, Plane или PlanarMat.
+template<class Image, class Processor>
+void DoFilter(Image& src, Image& dst, Processor proc, const Border& border, const Rect& pixels) {
+    const std::size_t r = proc.kernelSize / 2;
+    const std::size_t top = std::min(r, src.rows);
+    const std::size_t bottom = std::max(src.rows - top, top);
+    const std::size_t left = std::min(r, src.cols);
+    const std::size_t right = std::max(src.cols - left, left);
+
+    const std::size_t y0 = pixels.y;
+    const std::size_t y1 = pixels.y + pixels.height;
+    const std::size_t x0 = pixels.x;
+    const std::size_t x1 = pixels.x + pixels.width;
+
+    // Строки [y0, y1) делятся на верхнюю полосу, середину и нижнюю полосу,
+    // столбцы середины - так же.
+    const std::size_t midY0 = std::clamp(top, y0, y1);
+    const std::size_t midY1 = std::clamp(bottom, midY0, y1);
+    const std::size_t midX0 = std::clamp(left, x0, x1);
+    const std::size_t midX1 = std::clamp(right, midX0, x1);
+
+    auto gathered = [&](std::size_t ya, std::size_t yb, std::size_t xa, std::size_t xb) {
+        if (ya < yb && xa < xb) {
+            DoFilterGathered(src, dst, proc, border, Rect(xa, ya, xb - xa, yb - ya));
+        }
+    };
+
+    gathered(y0, midY0, x0, x1);
+    gathered(midY1, y1, x0, x1);
+    gathered(midY0, midY1, x0, midX0);
+    gathered(midY0, midY1, midX1, x1);
+
+    if (midY0 < midY1 && midX0 < midX1) {
+        DoFilter(src, dst, proc, Rect(midX0 - r, midY0 - r, midX1 - midX0, midY1 - midY0));
+    }
+}
+
+template<class Image, class Processor>
+void DoFilter(Image& src, Image& dst, Processor proc, const Border& border) {
+    DoFilter(src, dst, proc, border, Rect(0, 0, src.cols, src.rows));
+}
+
+// То же по полосам строк между потоками OpenMP.
+template<class Image, class Processor>
+void ParallelDoFilter(Image& src, Image& dst, Processor proc, const Border& border) {
+    #pragma omp parallel
+    {
+        const std::size_t threads = omp_get_num_threads();
+        const std::size_t id = omp_get_thread_num();
+        const std::size_t begin = src.rows * id / threads;
+        const std::size_t end = src.rows * (id + 1) / threads;
+
+        if (begin < end) {
+            DoFilter(src, dst, proc, border, Rect(0, begin, src.cols, end - begin));
+        }
+    }
+}
+
+} // namespace pp
+
+#endif
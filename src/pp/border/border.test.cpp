@@ -0,0 +1,162 @@
+#include "pp/border/border.hpp"
+
+#include "pp/cpu/cpu.hpp"
+#include "pp/mean/mean.hpp"
+#include "pp/median/median.hpp"
+#include "pp/transformation/transformation.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+
+namespace {
+
+constexpr pp::CpuLevel kLevels[] = {
+    pp::CpuLevel::kScalar, pp::CpuLevel::kSse41, pp::CpuLevel::kAvx2, pp::CpuLevel::kAvx512,
+};
+
+constexpr pp::BorderMode kModes[] = {
+    pp::BorderMode::kReflect, pp::BorderMode::kReplicate, pp::BorderMode::kConstant, pp::BorderMode::kWrap,
+};
+
+pp::Mat RandomMat(std::size_t rows, std::size_t cols, std::mt19937& rng) {
+    std::uniform_int_distribution<int> value(0, 255);
+    pp::Mat img(rows, cols);
+    for (std::size_t row = 0; row < rows; ++row) {
+        for (std::size_t j = 0; j < cols * 3; ++j) {
+            img.GetPtr(row, 0)[j] = static_cast<uint8_t>(value(rng));
+        }
+    }
+    return img;
+}
+
+// Копия src с физической рамкой r, достроенной по border попиксельно.
+pp::Mat Padded(const pp::Mat& src, std::size_t r, const pp::Border& border) {
+    const auto rows = static_cast<std::ptrdiff_t>(src.rows);
+    const auto cols = static_cast<std::ptrdiff_t>(src.cols);
+    const auto pad = static_cast<std::ptrdiff_t>(r);
+
+    pp::Mat padded(src.rows + 2 * r, src.cols + 2 * r, r);
+    for (std::ptrdiff_t i = -pad; i < rows + pad; ++i) {
+        for (std::ptrdiff_t j = -pad; j < cols + pad; ++j) {
+            uint8_t* dst = padded.GetPtr(i + pad, j + pad);
+            const std::ptrdiff_t y = pp::BorderIndex(i, rows, border.mode);
+            const std::ptrdiff_t x = pp::BorderIndex(j, cols, border.mode);
+            if (y < 0 || x < 0) {
+                std::memset(dst, border.value, 3);
+            } else {
+                std::memcpy(dst, src.GetPtr(y, x), 3);
+            }
+        }
+    }
+    return padded;
+}
+
+bool SameInterior(const pp::Mat& result, const pp::Mat& padded, std::size_t r) {
+    for (std::size_t row = 0; row < result.rows; ++row) {
+        if (std::memcmp(result.GetPtr(row, 0), padded.GetPtr(row + r, r), result.cols * 3) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Результат DoFilter с Border совпадает с DoFilter по кадру с физической
+// рамкой для всех режимов, уровней CPU и размеров, в том числе меньших окна.
+template<class Processor>
+void ExpectMatchesPadded(const Processor& proc) {
+    const std::size_t r = proc.kernelSize / 2;
+    std::mt19937 rng(static_cast<unsigned>(proc.kernelSize));
+    std::uniform_int_distribution<std::size_t> extent(1, 40);
+
+    for (pp::CpuLevel level: kLevels) {
+        if (level > pp::DetectedCpuLevel()) {
+            continue;
+        }
+        SCOPED_TRACE(pp::ToString(level));
+        pp::ForceCpuLevel(level);
+
+        for (pp::BorderMode mode: kModes) {
+            SCOPED_TRACE(pp::ToString(mode));
+            const pp::Border border{mode, 17};
+
+            for (int iteration = 0; iteration < 6; ++iteration) {
+                const std::size_t rows = extent(rng);
+                const std::size_t cols = extent(rng);
+                SCOPED_TRACE(testing::Message() << rows << "x" << cols);
+
+                pp::Mat src = RandomMat(rows, cols, rng);
+                pp::Mat padded = Padded(src, r, border);
+                pp::Mat expected(padded.rows, padded.cols);
+                pp::DoFilter(padded, expected, proc);
+
+                pp::Mat dst(rows, cols);
+                pp::DoFilter(src, dst, proc, border);
+                EXPECT_TRUE(SameInterior(dst, expected, r));
+
+                pp::Mat parallel(rows, cols);
+                pp::ParallelDoFilter(src, parallel, proc, border);
+                EXPECT_TRUE(SameInterior(parallel, expected, r));
+
+                // Планарные процессоры могут считать иначе, чем чередующиеся
+                // (Sobel - поканально), поэтому эталон - свой.
+                pp::PlanarMat planarPadded(padded);
+                pp::PlanarMat planarExpected(padded.rows, padded.cols);
+                pp::DoFilter(planarPadded, planarExpected, proc);
+
+                pp::PlanarMat planarSrc(src);
+                pp::PlanarMat planarDst(rows, cols);
+                pp::DoFilter(planarSrc, planarDst, proc, border);
+                EXPECT_TRUE(SameInterior(planarDst.ToMat(), planarExpected.ToMat(), r));
+            }
+        }
+    }
+    pp::ResetCpuLevel();
+}
+
+TEST(VirtualBorder, BoxMeanMatchesPaddedFrame) {
+    ExpectMatchesPadded(pp::BoxMeanFilterProc(5));
+}
+
+TEST(VirtualBorder, HistogramMedianMatchesPaddedFrame) {
+    ExpectMatchesPadded(pp::HistogramMedianFilterProc(3));
+}
+
+TEST(VirtualBorder, SobelMatchesPaddedFrame) {
+    ExpectMatchesPadded(pp::SobelFilterProc());
+}
+
+TEST(VirtualBorder, ReflectMatchesMirrorBorder) {
+    std::mt19937 rng(7);
+    pp::Mat src = RandomMat(23, 31, rng);
+    pp::Mat bordered = src.CopyWithBorder(2);
+    bordered.MakeMirrorBorder(2);
+    pp::Mat expected(bordered.rows, bordered.cols);
+    pp::DoFilter(bordered, expected, pp::MedianFilterProc(5));
+
+    pp::Mat dst(src.rows, src.cols);
+    pp::DoFilter(src, dst, pp::MedianFilterProc(5), pp::Border{});
+    EXPECT_TRUE(SameInterior(dst, expected, 2));
+}
+
+TEST(BorderIndex, MapsOutsideCoordinates) {
+    EXPECT_EQ(pp::BorderIndex(-1, 5, pp::BorderMode::kReflect), 0);
+    EXPECT_EQ(pp::BorderIndex(5, 5, pp::BorderMode::kReflect), 4);
+    EXPECT_EQ(pp::BorderIndex(-3, 5, pp::BorderMode::kReplicate), 0);
+    EXPECT_EQ(pp::BorderIndex(7, 5, pp::BorderMode::kReplicate), 4);
+    EXPECT_EQ(pp::BorderIndex(-1, 5, pp::BorderMode::kConstant), -1);
+    EXPECT_EQ(pp::BorderIndex(-1, 5, pp::BorderMode::kWrap), 4);
+    EXPECT_EQ(pp::BorderIndex(6, 5, pp::BorderMode::kWrap), 1);
+}
+
+TEST(BorderMode, ParsesNames) {
+    for (pp::BorderMode mode: kModes) {
+        EXPECT_EQ(pp::ParseBorderMode(pp::ToString(mode)), mode);
+    }
+    EXPECT_THROW(pp::ParseBorderMode("mirror"), std::invalid_argument);
+}
+
+} // namespace
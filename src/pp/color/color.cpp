@@ -0,0 +1,326 @@
+#include "pp/color/color.hpp"
+#include "pp/cpu/cpu.hpp"
+#include "pp/pixel/pixel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace pp {
+namespace {
+
+constexpr float kPi = 3.14159265358979f;
+
+// Коэффициенты K[H] обратного преобразования по каналам R, G, B.
+struct HueTable {
+    std::array<float, 256> r;
+    std::array<float, 256> g;
+    std::array<float, 256> b;
+};
+
+double HueDegrees(std::size_t h) {
+    return h * 360. / 256.;
+}
+
+double CosDegree(double degree) {
+    return std::cos(M_PI * degree / 180.);
+}
+
+// Из PixelRGB(PixelHSV): канал равен m + C * coef = V + V * s * (coef - 1),
+// где coef - 1, X / C или 0 в зависимости от сектора тона.
+HueTable MakeHsvTable() {
+    HueTable table;
+
+    for (std::size_t h = 0; h < 256; ++h) {
+        const double hue = HueDegrees(h);
+        const double x = 1 - std::abs(std::fmod(hue / 60., 2) - 1);
+
+        double r, g, b;
+        if (hue < 60) {
+            r = 1; g = x; b = 0;
+        } else if (hue < 120) {
+            r = x; g = 1; b = 0;
+        } else if (hue < 180) {
+            r = 0; g = 1; b = x;
+        } else if (hue < 240) {
+            r = 0; g = x; b = 1;
+        } else if (hue < 300) {
+            r = x; g = 0; b = 1;
+        } else {
+            r = 1; g = 0; b = x;
+        }
+
+        table.r[h] = static_cast<float>(r - 1);
+        table.g[h] = static_cast<float>(g - 1);
+        table.b[h] = static_cast<float>(b - 1);
+    }
+
+    return table;
+}
+
+// Из PixelRGB(PixelHSI): в секторе тона три канала равны I * (1 - s),
+// I * (1 + s * q) и 3I минус их сумма = I * (1 + s * (1 - q)),
+// где q = cos(H) / cos(60 - H).
+HueTable MakeHsiTable() {
+    HueTable table;
+
+    for (std::size_t h = 0; h < 256; ++h) {
+        double hue = HueDegrees(h);
+
+        float* v1;
+        float* v2;
+        float* v3;
+        if (hue < 120) {
+            v1 = &table.b[h]; v2 = &table.r[h]; v3 = &table.g[h];
+        } else if (hue < 240) {
+            hue -= 120;
+            v1 = &table.r[h]; v2 = &table.g[h]; v3 = &table.b[h];
+        } else {
+            hue -= 240;
+            v1 = &table.g[h]; v2 = &table.b[h]; v3 = &table.r[h];
+        }
+
+        const double q = CosDegree(hue) / CosDegree(60 - hue);
+        *v1 = -1.f;
+        *v2 = static_cast<float>(q);
+        *v3 = static_cast<float>(1 - q);
+    }
+
+    return table;
+}
+
+const HueTable& HsvTable() {
+    static const HueTable table = MakeHsvTable();
+    return table;
+}
+
+const HueTable& HsiTable() {
+    static const HueTable table = MakeHsiTable();
+    return table;
+}
+
+PP_ALWAYS_INLINE uint8_t Saturate(float value) {
+    return static_cast<uint8_t>(static_cast<int32_t>(std::min(std::max(value, 0.f), 255.f) + 0.5f));
+}
+
+// Тон в долях полного круга t (256 - полный круг, допускаются
+// отрицательные значения до -256) в байт H.
+PP_ALWAYS_INLINE uint8_t HueByte(float t) {
+    t = (t < 0.f) ? t + 256.f : t;
+    // 255.5 и выше округляется до 256 и переносится в 0.
+    return static_cast<uint8_t>(static_cast<int32_t>(t + 0.5f));
+}
+
+// atan2 без ветвлений: многочлен Abramowitz-Stegun 4.4.49 на [0, 1]
+// (ошибка до 1e-5 рад) и приведение по октантам. atan2(0, 0) = 0.
+PP_ALWAYS_INLINE float Atan2(float y, float x) {
+    const float ax = std::abs(x);
+    const float ay = std::abs(y);
+    const float a = std::min(ax, ay) / std::max(std::max(ax, ay), 1e-30f);
+    const float s = a * a;
+
+    const float r = a * (0.9998660f + s * (-0.3302995f + s * (0.1801410f + s * (-0.0851330f + s * 0.0208351f))));
+    const float r1 = (ay > ax) ? 0.5f * kPi - r : r;
+    const float r2 = (x < 0.f) ? kPi - r1 : r1;
+    return (y < 0.f) ? -r2 : r2;
+}
+
+template<std::size_t kSrcStep, std::size_t kDstStep>
+PP_ALWAYS_INLINE void RgbToHsvRowImpl(const uint8_t* r, const uint8_t* g, const uint8_t* b,
+                                      uint8_t* h, uint8_t* s, uint8_t* v, std::size_t cols) {
+    #pragma omp simd
+    for (std::size_t col = 0; col < cols; ++col) {
+        const float rf = r[col * kSrcStep];
+        const float gf = g[col * kSrcStep];
+        const float bf = b[col * kSrcStep];
+
+        const float cmax = std::max(rf, std::max(gf, bf));
+        const float delta = cmax - std::min(rf, std::min(gf, bf));
+        const float invDelta = 1.f / std::max(delta, 1.f);
+
+        const float hueR = (gf - bf) * invDelta;
+        const float hueG = (bf - rf) * invDelta + 2.f;
+        const float hueB = (rf - gf) * invDelta + 4.f;
+        // Порядок проверок как в PixelHSV: сначала R, затем G.
+        const float hue = (cmax == rf) ? hueR : ((cmax == gf) ? hueG : hueB);
+
+        h[col * kDstStep] = HueByte(hue * (256.f / 6.f));
+        s[col * kDstStep] = static_cast<uint8_t>(static_cast<int32_t>(delta * 255.f / std::max(cmax, 1.f) + 0.5f));
+        v[col * kDstStep] = static_cast<uint8_t>(cmax);
+    }
+}
+
+template<std::size_t kSrcStep, std::size_t kDstStep>
+PP_ALWAYS_INLINE void RgbToHsiRowImpl(const uint8_t* r, const uint8_t* g, const uint8_t* b,
+                                      uint8_t* h, uint8_t* s, uint8_t* i, std::size_t cols) {
+    #pragma omp simd
+    for (std::size_t col = 0; col < cols; ++col) {
+        const float rf = r[col * kSrcStep];
+        const float gf = g[col * kSrcStep];
+        const float bf = b[col * kSrcStep];
+
+        const float sum = rf + gf + bf;
+        const float cmin = std::min(rf, std::min(gf, bf));
+
+        // acos((2R - G - B) / (2 * sqrt(...))) с выбором 360 - teta при B > G
+        // совпадает с atan2(sqrt(3) * (G - B), 2R - G - B).
+        const float hue = Atan2(1.7320508f * (gf - bf), 2.f * rf - gf - bf);
+
+        h[col * kDstStep] = HueByte(hue * (128.f / kPi));
+        s[col * kDstStep] = static_cast<uint8_t>(static_cast<int32_t>((sum - 3.f * cmin) * 255.f / std::max(sum, 1.f) + 0.5f));
+        // sum / 3 не бывает ровно x.5, поэтому умножение на 1/3 округляется верно.
+        i[col * kDstStep] = static_cast<uint8_t>(static_cast<int32_t>(sum * (1.f / 3.f) + 0.5f));
+    }
+}
+
+template<std::size_t kSrcStep, std::size_t kDstStep>
+PP_ALWAYS_INLINE void ToRgbRowImpl(const float* kr, const float* kg, const float* kb,
+                                   const uint8_t* h, const uint8_t* s, const uint8_t* y,
+                                   uint8_t* r, uint8_t* g, uint8_t* b, std::size_t cols) {
+    #pragma omp simd
+    for (std::size_t col = 0; col < cols; ++col) {
+        const uint8_t hue = h[col * kSrcStep];
+        const float yf = y[col * kSrcStep];
+        const float ys = yf * (s[col * kSrcStep] * (1.f / 255.f));
+
+        r[col * kDstStep] = Saturate(yf + ys * kr[hue]);
+        g[col * kDstStep] = Saturate(yf + ys * kg[hue]);
+        b[col * kDstStep] = Saturate(yf + ys * kb[hue]);
+    }
+}
+
+template<std::size_t kSrcStep, std::size_t kDstStep>
+PP_ALWAYS_INLINE void ConvertColorSteps(ColorConversion conversion, const HueTable* table,
+                                        const uint8_t* s0, const uint8_t* s1, const uint8_t* s2,
+                                        uint8_t* d0, uint8_t* d1, uint8_t* d2, std::size_t cols) {
+    switch (conversion) {
+        case ColorConversion::kRgbToHsv:
+            RgbToHsvRowImpl<kSrcStep, kDstStep>(s0, s1, s2, d0, d1, d2, cols);
+            break;
+        case ColorConversion::kRgbToHsi:
+            RgbToHsiRowImpl<kSrcStep, kDstStep>(s0, s1, s2, d0, d1, d2, cols);
+            break;
+        case ColorConversion::kHsvToRgb:
+        case ColorConversion::kHsiToRgb:
+            ToRgbRowImpl<kSrcStep, kDstStep>(table->r.data(), table->g.data(), table->b.data(),
+                                             s0, s1, s2, d0, d1, d2, cols);
+            break;
+    }
+}
+
+// Шаги пикселя - параметры шаблона: загрузки и записи с шагом 3 векторизуются.
+PP_ALWAYS_INLINE void ConvertColorRowImpl(ColorConversion conversion, const HueTable* table,
+                                          const uint8_t* s0, const uint8_t* s1, const uint8_t* s2,
+                                          std::size_t srcPixelStep,
+                                          uint8_t* d0, uint8_t* d1, uint8_t* d2,
+                                          std::size_t dstPixelStep, std::size_t cols) {
+    if (srcPixelStep == 3) {
+        if (dstPixelStep == 3) {
+            ConvertColorSteps<3, 3>(conversion, table, s0, s1, s2, d0, d1, d2, cols);
+        } else {
+            ConvertColorSteps<3, 1>(conversion, table, s0, s1, s2, d0, d1, d2, cols);
+        }
+    } else {
+        if (dstPixelStep == 3) {
+            ConvertColorSteps<1, 3>(conversion, table, s0, s1, s2, d0, d1, d2, cols);
+        } else {
+            ConvertColorSteps<1, 1>(conversion, table, s0, s1, s2, d0, d1, d2, cols);
+        }
+    }
+}
+
+PP_CPU_VARIANTS(void, ConvertColorRow, ConvertColorRowImpl,
+                (ColorConversion conversion, const HueTable* table,
+                 const uint8_t* s0, const uint8_t* s1, const uint8_t* s2, std::size_t srcPixelStep,
+                 uint8_t* d0, uint8_t* d1, uint8_t* d2, std::size_t dstPixelStep, std::size_t cols),
+                (conversion, table, s0, s1, s2, srcPixelStep, d0, d1, d2, dstPixelStep, cols))
+
+void ConvertToPlanar(ColorConversion conversion, const Mat& src, PlanarMat& dst) {
+    if (dst.rows != src.rows || dst.cols != src.cols) {
+        PlanarMat(src.rows, src.cols).swap(dst);
+    }
+    dst.borderSize = src.borderSize;
+    for (auto& plane: dst.planes) {
+        plane.borderSize = src.borderSize;
+    }
+
+    for (std::size_t row = 0; row < src.rows; ++row) {
+        const uint8_t* s = src.GetPtr(row, 0);
+        ConvertColorRow(conversion, s, s + 1, s + 2, 3,
+                        dst.planes[0].GetPtr(row, 0), dst.planes[1].GetPtr(row, 0),
+                        dst.planes[2].GetPtr(row, 0), 1, src.cols);
+    }
+}
+
+void ConvertToInterleaved(ColorConversion conversion, const PlanarMat& src, Mat& dst) {
+    if (dst.rows != src.rows || dst.cols != src.cols) {
+        Mat(src.rows, src.cols).swap(dst);
+    }
+    dst.borderSize = src.borderSize;
+
+    for (std::size_t row = 0; row < src.rows; ++row) {
+        uint8_t* d = dst.GetPtr(row, 0);
+        ConvertColorRow(conversion, src.planes[0].GetPtr(row, 0), src.planes[1].GetPtr(row, 0),
+                        src.planes[2].GetPtr(row, 0), 1, d, d + 1, d + 2, 3, src.cols);
+    }
+}
+
+} // namespace
+
+std::string ToString(ColorConversion conversion) {
+    switch (conversion) {
+        case ColorConversion::kRgbToHsv: return "RgbToHsv";
+        case ColorConversion::kHsvToRgb: return "HsvToRgb";
+        case ColorConversion::kRgbToHsi: return "RgbToHsi";
+        case ColorConversion::kHsiToRgb: return "HsiToRgb";
+    }
+    return "unknown";
+}
+
+void ConvertColorRow(ColorConversion conversion,
+                     const uint8_t* src0, const uint8_t* src1, const uint8_t* src2, std::size_t srcPixelStep,
+                     uint8_t* dst0, uint8_t* dst1, uint8_t* dst2, std::size_t dstPixelStep,
+                     std::size_t cols) {
+    const HueTable* table = (conversion == ColorConversion::kHsiToRgb) ? &HsiTable() : &HsvTable();
+
+    PP_CPU_DISPATCH(ConvertColorRow, (conversion, table, src0, src1, src2, srcPixelStep,
+                                      dst0, dst1, dst2, dstPixelStep, cols));
+}
+
+void RgbToHsv(const Mat& src, PlanarMat& dst) {
+    ConvertToPlanar(ColorConversion::kRgbToHsv, src, dst);
+}
+
+void RgbToHsi(const Mat& src, PlanarMat& dst) {
+    ConvertToPlanar(ColorConversion::kRgbToHsi, src, dst);
+}
+
+void HsvToRgb(const PlanarMat& src, Mat& dst) {
+    ConvertToInterleaved(ColorConversion::kHsvToRgb, src, dst);
+}
+
+void HsiToRgb(const PlanarMat& src, Mat& dst) {
+    ConvertToInterleaved(ColorConversion::kHsiToRgb, src, dst);
+}
+
+void ColorConversionProc::ProcessBlock(Mat& src, Mat& dst, const Rect& windows) const {
+    for (std::size_t row = windows.y; row < windows.y + windows.height; ++row) {
+        const uint8_t* s = src.GetPtr(row, windows.x);
+        uint8_t* d = dst.GetPtr(row, windows.x);
+        ConvertColorRow(conversion, s, s + 1, s + 2, 3, d, d + 1, d + 2, 3, windows.width);
+    }
+}
+
+void ColorConversionProc::ProcessBlock(PlanarMat& src, PlanarMat& dst, const Rect& windows) const {
+    for (std::size_t row = windows.y; row < windows.y + windows.height; ++row) {
+        ConvertColorRow(conversion,
+                        src.planes[0].GetPtr(row, windows.x), src.planes[1].GetPtr(row, windows.x),
+                        src.planes[2].GetPtr(row, windows.x), 1,
+                        dst.planes[0].GetPtr(row, windows.x), dst.planes[1].GetPtr(row, windows.x),
+                        dst.planes[2].GetPtr(row, windows.x), 1, windows.width);
+    }
+}
+
+} // namespace pp
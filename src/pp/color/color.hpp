@@ -0,0 +1,71 @@
+#ifndef IMAGE_PREPROCESSING_PP_COLOR_HPP_
+#define IMAGE_PREPROCESSING_PP_COLOR_HPP_
+
+#include "pp/mat/mat.hpp"
+#include "pp/planar/planar.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace pp {
+
+// Преобразования цветовых пространств для целых изображений.
+//
+// HSV и HSI хранятся в 8 битах на канал, в порядке PixelHSV::Pos /
+// PixelHSI::Pos:
+//   H = round(h * 256 / 360) mod 256, h - тон в градусах;
+//   S = round(s * 255);
+//   V = max(R, G, B), I = round((R + G + B) / 3).
+// Для серых пикселей (тон не определён) H = 0.
+//
+// Прямые преобразования считаются во float без ветвлений, тон HSI - через
+// atan2 (равносилен формуле с acos в PixelHSI). Обратные используют таблицы
+// на 256 значений H: каждый канал равен Y + Y * s * K[H], где Y - V или I.
+//
+// Точность относительно PixelHSV / PixelHSI (тон сравнивается по модулю 360):
+//   H - не больше 0.71 градуса (половина шага 360/256) от точного тона;
+//     PixelHSI добавляет 1e-6 к знаменателю и для пикселей, отличающихся
+//     от серого на 1-2 уровня, сам отходит от точного тона до 1.3 градуса;
+//   S - не больше 0.5 / 255; V, I - точно после округления;
+//   обратное преобразование - не больше 1 по каждому каналу от PixelRGB,
+//   построенного из того же (h, s, v/i); HSI ограничивается [0, 255].
+enum class ColorConversion {
+    kRgbToHsv,
+    kHsvToRgb,
+    kRgbToHsi,
+    kHsiToRgb,
+};
+
+std::string ToString(ColorConversion conversion);
+
+// Преобразует cols пикселей. Каналы источника и приёмника заданы
+// отдельными указателями с шагом пикселя 3 (Mat) или 1 (Plane);
+// src и dst могут совпадать.
+void ConvertColorRow(ColorConversion conversion,
+                     const uint8_t* src0, const uint8_t* src1, const uint8_t* src2, std::size_t srcPixelStep,
+                     uint8_t* dst0, uint8_t* dst1, uint8_t* dst2, std::size_t dstPixelStep,
+                     std::size_t cols);
+
+// Mat в планарное HSV/HSI и обратно; размер и рамка приёмника берутся
+// из источника.
+void RgbToHsv(const Mat& src, PlanarMat& dst);
+void RgbToHsi(const Mat& src, PlanarMat& dst);
+void HsvToRgb(const PlanarMat& src, Mat& dst);
+void HsiToRgb(const PlanarMat& src, Mat& dst);
+
+// Поточечное преобразование как стадия конвейера: каналы Mat (или
+// плоскости PlanarMat) переписываются в другом пространстве.
+class ColorConversionProc {
+public:
+    ColorConversionProc(ColorConversion conversion): conversion(conversion) {}
+    void ProcessBlock(Mat& src, Mat& dst, const Rect& windows) const;
+    void ProcessBlock(PlanarMat& src, PlanarMat& dst, const Rect& windows) const;
+
+    ColorConversion conversion;
+    static constexpr std::size_t kernelSize = 1;
+};
+
+} // namespace pp
+
+#endif
@@ -0,0 +1,102 @@
+#include "pp/cpu/cpu.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <initializer_list>
+#include <stdexcept>
+
+namespace pp {
+namespace {
+
+constexpr int kNotForced = -1;
+
+std::atomic<int> forcedLevel{kNotForced};
+
+CpuLevel Detect() {
+#ifdef PP_CPU_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        return CpuLevel::kAvx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return CpuLevel::kAvx2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return CpuLevel::kSse41;
+    }
+#endif
+    return CpuLevel::kScalar;
+}
+
+// DetectedCpuLevel() с учётом PP_CPU_LEVEL. Неизвестное значение не
+// бросает исключение (его некому поймать в ядре внутри параллельной
+// области): предупреждение и уровень процессора.
+CpuLevel ReadDefaultLevel() {
+    const CpuLevel detected = DetectedCpuLevel();
+    const char* env = std::getenv("PP_CPU_LEVEL");
+    if (env == nullptr || *env == '\0') {
+        return detected;
+    }
+
+    try {
+        return std::min(ParseCpuLevel(env), detected);
+    } catch (const std::invalid_argument& e) {
+        std::fprintf(stderr, "%s (PP_CPU_LEVEL), using %s\n", e.what(), ToString(detected).c_str());
+        return detected;
+    }
+}
+
+CpuLevel DefaultLevel() {
+    static const CpuLevel level = ReadDefaultLevel();
+    return level;
+}
+
+// Переменная окружения разбирается при запуске программы, а не при первом
+// вызове ядра.
+[[maybe_unused]] const CpuLevel startupLevel = DefaultLevel();
+
+} // namespace
+
+CpuLevel DetectedCpuLevel() {
+    static const CpuLevel level = Detect();
+    return level;
+}
+
+CpuLevel ActiveCpuLevel() {
+    const int forced = forcedLevel.load(std::memory_order_relaxed);
+    if (forced == kNotForced) {
+        return DefaultLevel();
+    }
+    return static_cast<CpuLevel>(forced);
+}
+
+void ForceCpuLevel(CpuLevel level) {
+    forcedLevel = static_cast<int>(std::min(level, DetectedCpuLevel()));
+}
+
+void ResetCpuLevel() {
+    forcedLevel = kNotForced;
+}
+
+std::string ToString(CpuLevel level) {
+    switch (level) {
+        case CpuLevel::kScalar: return "scalar";
+        case CpuLevel::kSse41: return "sse4.1";
+        case CpuLevel::kAvx2: return "avx2";
+        case CpuLevel::kAvx512: return "avx512";
+    }
+    return "unknown";
+}
+
+CpuLevel ParseCpuLevel(const std::string& name) {
+    for (CpuLevel level: {CpuLevel::kScalar, CpuLevel::kSse41, CpuLevel::kAvx2, CpuLevel::kAvx512}) {
+        if (ToString(level) == name) {
+            return level;
+        }
+    }
+    throw std::invalid_argument("Unknown CPU level: " + name);
+}
+
+} // namespace pp
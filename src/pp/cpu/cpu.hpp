@@ -0,0 +1,72 @@
+#ifndef IMAGE_PREPROCESSING_PP_CPU_HPP_
+#define IMAGE_PREPROCESSING_PP_CPU_HPP_
+
+#include <string>
+
+namespace pp {
+
+// Наборы инструкций, под которые собираются пиксельные ядра.
+enum class CpuLevel {
+    kScalar = 0,
+    kSse41 = 1,
+    kAvx2 = 2,
+    kAvx512 = 3,
+};
+
+// Лучший уровень, который поддерживают процессор и ОС.
+CpuLevel DetectedCpuLevel();
+
+// Уровень, по которому ядра выбирают реализацию: DetectedCpuLevel(),
+// ограниченный сверху ForceCpuLevel() или переменной окружения
+// PP_CPU_LEVEL (scalar, sse4.1, avx2, avx512). PP_CPU_LEVEL читается при
+// запуске; неизвестное значение - предупреждение в stderr и
+// DetectedCpuLevel().
+CpuLevel ActiveCpuLevel();
+
+// Ограничивает уровень для бенчмарков и сравнения реализаций. Уровень выше
+// поддерживаемого понижается до DetectedCpuLevel().
+void ForceCpuLevel(CpuLevel level);
+void ResetCpuLevel();
+
+std::string ToString(CpuLevel level);
+
+// Разбирает имя уровня ("scalar", "sse4.1", "avx2", "avx512");
+// для неизвестного имени бросает std::invalid_argument.
+CpuLevel ParseCpuLevel(const std::string& name);
+
+} // namespace pp
+
+// Ядро пишется один раз как PP_ALWAYS_INLINE функция Impl, а
+// PP_CPU_VARIANTS собирает из неё Name##Scalar/Sse41/Avx2/Avx512 с
+// соответствующими target-атрибутами: векторизатор обрабатывает тело
+// отдельно под каждый набор инструкций. PP_CPU_DISPATCH вызывает вариант
+// для ActiveCpuLevel(). Params и Args - списки в скобках.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PP_CPU_X86 1
+#define PP_ALWAYS_INLINE inline __attribute__((always_inline))
+#define PP_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define PP_TARGET_AVX2 __attribute__((target("avx2")))
+#define PP_TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+#else
+#define PP_ALWAYS_INLINE inline
+#define PP_TARGET_SSE41
+#define PP_TARGET_AVX2
+#define PP_TARGET_AVX512
+#endif
+
+#define PP_CPU_VARIANTS(Ret, Name, Impl, Params, Args)        \
+    Ret Name##Scalar Params { return Impl Args; }              \
+    PP_TARGET_SSE41 Ret Name##Sse41 Params { return Impl Args; } \
+    PP_TARGET_AVX2 Ret Name##Avx2 Params { return Impl Args; }   \
+    PP_TARGET_AVX512 Ret Name##Avx512 Params { return Impl Args; }
+
+#define PP_CPU_DISPATCH(Name, Args)                           \
+    switch (::pp::ActiveCpuLevel()) {                         \
+        case ::pp::CpuLevel::kAvx512: return Name##Avx512 Args; \
+        case ::pp::CpuLevel::kAvx2: return Name##Avx2 Args;     \
+        case ::pp::CpuLevel::kSse41: return Name##Sse41 Args;   \
+        case ::pp::CpuLevel::kScalar: break;                    \
+    }                                                         \
+    return Name##Scalar Args
+
+#endif
@@ -0,0 +1,160 @@
+#include "pp/cpu/cpu.hpp"
+
+#include "pp/color/color.hpp"
+#include "pp/gradient/gradient.hpp"
+#include "pp/mean/mean.hpp"
+#include "pp/planar/planar.hpp"
+#include "pp/transformation/transformation.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+constexpr pp::CpuLevel kLevels[] = {
+    pp::CpuLevel::kScalar, pp::CpuLevel::kSse41, pp::CpuLevel::kAvx2, pp::CpuLevel::kAvx512,
+};
+
+pp::Mat RandomMat(std::size_t rows, std::size_t cols, std::mt19937& rng) {
+    std::uniform_int_distribution<int> value(0, 255);
+    pp::Mat img(rows, cols);
+    for (std::size_t row = 0; row < rows; ++row) {
+        for (std::size_t j = 0; j < cols * 3; ++j) {
+            img.GetPtr(row, 0)[j] = static_cast<uint8_t>(value(rng));
+        }
+    }
+    return img;
+}
+
+// run(src) на каждом поддерживаемом уровне даёт то же, что на kScalar.
+// Ширины кадров некратны ширине векторов, чтобы задеть хвосты строк.
+template<class Result>
+void ExpectSameOnEveryLevel(const std::function<Result(const pp::Mat&)>& run) {
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<std::size_t> extent(3, 97);
+
+    for (int iteration = 0; iteration < 6; ++iteration) {
+        const pp::Mat src = RandomMat(extent(rng), extent(rng), rng);
+        SCOPED_TRACE(testing::Message() << src.rows << "x" << src.cols);
+
+        pp::ForceCpuLevel(pp::CpuLevel::kScalar);
+        const Result expected = run(src);
+        for (pp::CpuLevel level: kLevels) {
+            if (level > pp::DetectedCpuLevel()) {
+                continue;
+            }
+            SCOPED_TRACE(pp::ToString(level));
+            pp::ForceCpuLevel(level);
+            EXPECT_TRUE(run(src) == expected);
+        }
+    }
+    pp::ResetCpuLevel();
+}
+
+TEST(CpuLevel, ParsesNames) {
+    for (pp::CpuLevel level: kLevels) {
+        EXPECT_EQ(pp::ParseCpuLevel(pp::ToString(level)), level);
+    }
+    EXPECT_THROW(pp::ParseCpuLevel("sse4"), std::invalid_argument);
+}
+
+TEST(CpuLevel, ForceIsCappedByDetected) {
+    pp::ForceCpuLevel(pp::CpuLevel::kAvx512);
+    EXPECT_EQ(pp::ActiveCpuLevel(), pp::DetectedCpuLevel());
+
+    pp::ForceCpuLevel(pp::CpuLevel::kScalar);
+    EXPECT_EQ(pp::ActiveCpuLevel(), pp::CpuLevel::kScalar);
+
+    pp::ResetCpuLevel();
+    EXPECT_LE(pp::ActiveCpuLevel(), pp::DetectedCpuLevel());
+}
+
+// Запускается и с PP_CPU_LEVEL=sse4 (см. CMakeLists.txt): неизвестное
+// значение не бросает, а оставляет уровень процессора.
+TEST(CpuLevel, UnknownEnvironmentLevelFallsBack) {
+    const char* env = std::getenv("PP_CPU_LEVEL");
+    if (env == nullptr || *env == '\0') {
+        GTEST_SKIP() << "PP_CPU_LEVEL is not set";
+    }
+
+    bool known = true;
+    try {
+        pp::ParseCpuLevel(env);
+    } catch (const std::invalid_argument&) {
+        known = false;
+    }
+    if (known) {
+        GTEST_SKIP() << "PP_CPU_LEVEL is a known level";
+    }
+
+    pp::ResetCpuLevel();
+    EXPECT_EQ(pp::ActiveCpuLevel(), pp::DetectedCpuLevel());
+}
+
+TEST(CpuDispatch, BoxMean) {
+    ExpectSameOnEveryLevel<pp::Mat>([](const pp::Mat& src) {
+        pp::Mat in = src;
+        pp::Mat dst = src;
+        pp::DoFilter(in, dst, pp::BoxMeanFilterProc(3));
+        return dst;
+    });
+}
+
+TEST(CpuDispatch, Threshold) {
+    ExpectSameOnEveryLevel<pp::Mat>([](const pp::Mat& src) {
+        pp::Mat in = src;
+        pp::Mat dst = src;
+        pp::DoFilter(in, dst, pp::ThresholdFilterProc(128));
+        return dst;
+    });
+}
+
+TEST(CpuDispatch, GrayscaleAndGradient) {
+    ExpectSameOnEveryLevel<pp::Mat>([](const pp::Mat& src) {
+        pp::Mat in = src;
+        pp::Mat dst = src;
+        pp::DoFilter(in, dst, pp::SobelFilterProc());
+        return dst;
+    });
+    ExpectSameOnEveryLevel<pp::Plane>([](const pp::Mat& src) {
+        pp::Plane gray(src.rows, src.cols);
+        pp::Grayscale(src, gray);
+        return gray;
+    });
+}
+
+TEST(CpuDispatch, InterleaveRoundTrip) {
+    ExpectSameOnEveryLevel<pp::Mat>([](const pp::Mat& src) {
+        pp::PlanarMat planar(src.rows, src.cols);
+        pp::Deinterleave(src, planar);
+        pp::Mat dst(src.rows, src.cols);
+        pp::Interleave(planar, dst);
+        return dst;
+    });
+}
+
+TEST(CpuDispatch, MirrorBorder) {
+    ExpectSameOnEveryLevel<pp::Mat>([](const pp::Mat& src) {
+        pp::Mat bordered = src;
+        bordered.MakeMirrorBorder(1);
+        return bordered;
+    });
+}
+
+TEST(CpuDispatch, ColorConversion) {
+    ExpectSameOnEveryLevel<pp::Mat>([](const pp::Mat& src) {
+        pp::PlanarMat hsv;
+        pp::RgbToHsv(src, hsv);
+        pp::Mat dst(src.rows, src.cols);
+        pp::HsvToRgb(hsv, dst);
+        return dst;
+    });
+}
+
+} // namespace
@@ -0,0 +1,252 @@
+#include "pp/gradient/gradient.hpp"
+#include "pp/cpu/cpu.hpp"
+#include "pp/pixel/pixel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace pp {
+namespace {
+
+// Веса PixelRGB::grayscale(), умноженные на kLumaScale.
+constexpr int32_t kLumaR = 2989;
+constexpr int32_t kLumaG = 5870;
+constexpr int32_t kLumaB = 1141;
+constexpr int32_t kLumaScale = 10000;
+
+// Строк яркости в одной полосе GrayGradient3x3.
+constexpr std::size_t kStripRows = 32;
+
+// Возвращает true, если в строке есть пиксели с яркостью ровно x.5:
+// для них записан результат целочисленного округления вверх, а double-веса
+// grayscale() могут дать и x, и x + 1.
+template<std::size_t kPixelStep>
+PP_ALWAYS_INLINE bool GrayscaleRowImpl(const uint8_t* r, const uint8_t* g, const uint8_t* b,
+                                       uint8_t* dst, std::size_t cols) {
+    int ties = 0;
+
+    #pragma omp simd reduction(|:ties)
+    for (std::size_t col = 0; col < cols; ++col) {
+        const int32_t n = kLumaR * r[col * kPixelStep] + kLumaG * g[col * kPixelStep]
+                        + kLumaB * b[col * kPixelStep] + kLumaScale / 2;
+
+        // n < 2^24, поэтому частное через float ошибается не больше чем на 1.
+        int32_t q = static_cast<int32_t>(static_cast<float>(n) * (1.f / kLumaScale));
+        q += (n - q * kLumaScale >= kLumaScale);
+        q -= (n - q * kLumaScale < 0);
+
+        ties |= (n == q * kLumaScale);
+        dst[col] = static_cast<uint8_t>(q);
+    }
+
+    return ties != 0;
+}
+
+// Округлённый корень m с переносом по модулю 256, как
+// static_cast<uint8_t>(std::round(std::sqrt(m))) в SegmentationFilterProc.
+PP_ALWAYS_INLINE uint8_t RoundedSqrt(int32_t m) {
+    int32_t s = static_cast<int32_t>(std::sqrt(static_cast<float>(m)) + 0.5f);
+    // round(sqrt(m)) == s  <=>  s*s - s < m <= s*s + s (для s > 0)
+    s += (m > s * s + s);
+    s -= (s > 0) & (m <= s * s - s);
+
+    return static_cast<uint8_t>(s);
+}
+
+PP_ALWAYS_INLINE void GradientRowImpl(const uint8_t* r0, const uint8_t* r1, const uint8_t* r2,
+                                      uint8_t* dst, std::size_t cols,
+                                      const int32_t* kx, const int32_t* ky) {
+    // |gx|, |gy| <= kMaxGradientKernelWeight * 255, поэтому свёртка
+    // считается в 16-битных дорожках, а 32 бита нужны только для квадратов.
+    const int16_t x0 = kx[0], x1 = kx[1], x2 = kx[2];
+    const int16_t x3 = kx[3], x4 = kx[4], x5 = kx[5];
+    const int16_t x6 = kx[6], x7 = kx[7], x8 = kx[8];
+    const int16_t y0 = ky[0], y1 = ky[1], y2 = ky[2];
+    const int16_t y3 = ky[3], y4 = ky[4], y5 = ky[5];
+    const int16_t y6 = ky[6], y7 = ky[7], y8 = ky[8];
+
+    #pragma omp simd
+    for (std::size_t col = 0; col < cols; ++col) {
+        const int16_t a0 = r0[col], a1 = r0[col + 1], a2 = r0[col + 2];
+        const int16_t b0 = r1[col], b1 = r1[col + 1], b2 = r1[col + 2];
+        const int16_t c0 = r2[col], c1 = r2[col + 1], c2 = r2[col + 2];
+
+        const int16_t gx = x0 * a0 + x1 * a1 + x2 * a2
+                         + x3 * b0 + x4 * b1 + x5 * b2
+                         + x6 * c0 + x7 * c1 + x8 * c2;
+        const int16_t gy = y0 * a0 + y1 * a1 + y2 * a2
+                         + y3 * b0 + y4 * b1 + y5 * b2
+                         + y6 * c0 + y7 * c1 + y8 * c2;
+
+        dst[col] = RoundedSqrt(int32_t{gx} * gx + int32_t{gy} * gy);
+    }
+}
+
+// Шаг пикселя - параметр шаблона: загрузки с шагом 3 векторизуются.
+PP_ALWAYS_INLINE bool GrayscaleRowsImpl(const uint8_t* r, const uint8_t* g, const uint8_t* b,
+                                        std::size_t pixelStep, uint8_t* dst, std::size_t cols) {
+    return pixelStep == 3 ? GrayscaleRowImpl<3>(r, g, b, dst, cols)
+                          : GrayscaleRowImpl<1>(r, g, b, dst, cols);
+}
+
+PP_CPU_VARIANTS(bool, GrayscaleRowSimd, GrayscaleRowsImpl,
+                (const uint8_t* r, const uint8_t* g, const uint8_t* b,
+                 std::size_t pixelStep, uint8_t* dst, std::size_t cols),
+                (r, g, b, pixelStep, dst, cols))
+
+PP_CPU_VARIANTS(void, GradientRow, GradientRowImpl,
+                (const uint8_t* r0, const uint8_t* r1, const uint8_t* r2,
+                 uint8_t* dst, std::size_t cols, const int32_t* kx, const int32_t* ky),
+                (r0, r1, r2, dst, cols, kx, ky))
+
+bool GrayscaleRowSimd(const uint8_t* r, const uint8_t* g, const uint8_t* b,
+                      std::size_t pixelStep, uint8_t* dst, std::size_t cols) {
+    PP_CPU_DISPATCH(GrayscaleRowSimd, (r, g, b, pixelStep, dst, cols));
+}
+
+void GradientRow(const uint8_t* r0, const uint8_t* r1, const uint8_t* r2,
+                 uint8_t* dst, std::size_t cols, const int32_t* kx, const int32_t* ky) {
+    PP_CPU_DISPATCH(GradientRow, (r0, r1, r2, dst, cols, kx, ky));
+}
+
+void GrayscaleRow(const uint8_t* r, const uint8_t* g, const uint8_t* b,
+                  std::size_t pixelStep, uint8_t* dst, std::size_t cols) {
+    if (!GrayscaleRowSimd(r, g, b, pixelStep, dst, cols)) {
+        return;
+    }
+
+    for (std::size_t col = 0; col < cols; ++col) {
+        const std::size_t i = col * pixelStep;
+        const int32_t n = kLumaR * r[i] + kLumaG * g[i] + kLumaB * b[i] + kLumaScale / 2;
+        if (n % kLumaScale == 0) {
+            dst[col] = PixelRGB(r[i], g[i], b[i]).grayscale();
+        }
+    }
+}
+
+// Буферы полосы: свои у каждого потока, растут до наибольшего окна.
+struct StripBuffers {
+    std::vector<uint8_t> gray;
+    std::vector<uint8_t> magnitude;
+};
+
+StripBuffers& LocalStripBuffers() {
+    thread_local StripBuffers buffers;
+    return buffers;
+}
+
+} // namespace
+
+void Grayscale(const uint8_t* src, std::size_t srcStep,
+               uint8_t* dst, std::size_t dstStep,
+               std::size_t rows, std::size_t cols) {
+    for (std::size_t row = 0; row < rows; ++row) {
+        const uint8_t* s = src + row * srcStep;
+        GrayscaleRow(s + PixelRGB::Pos::R, s + PixelRGB::Pos::G, s + PixelRGB::Pos::B, 3,
+                     dst + row * dstStep, cols);
+    }
+}
+
+void Grayscale(const uint8_t* r, const uint8_t* g, const uint8_t* b, std::size_t srcStep,
+               uint8_t* dst, std::size_t dstStep,
+               std::size_t rows, std::size_t cols) {
+    for (std::size_t row = 0; row < rows; ++row) {
+        GrayscaleRow(r + row * srcStep, g + row * srcStep, b + row * srcStep, 1,
+                     dst + row * dstStep, cols);
+    }
+}
+
+void Grayscale(const Mat& src, Plane& dst) {
+    if (dst.rows != src.rows || dst.cols != src.cols) {
+        Plane(src.rows, src.cols).swap(dst);
+    }
+    dst.borderSize = src.borderSize;
+
+    Grayscale(src.GetPtr(0, 0), src.step, dst.GetPtr(0, 0), dst.step, src.rows, src.cols);
+}
+
+void Grayscale(const PlanarMat& src, Plane& dst) {
+    if (dst.rows != src.rows || dst.cols != src.cols) {
+        Plane(src.rows, src.cols).swap(dst);
+    }
+    dst.borderSize = src.borderSize;
+
+    Grayscale(src[PixelRGB::Pos::R].GetPtr(0, 0), src[PixelRGB::Pos::G].GetPtr(0, 0),
+              src[PixelRGB::Pos::B].GetPtr(0, 0), src[PixelRGB::Pos::R].step,
+              dst.GetPtr(0, 0), dst.step, src.rows, src.cols);
+}
+
+void GradientMagnitude3x3(const uint8_t* src, std::size_t srcStep,
+                          uint8_t* dst, std::size_t dstStep,
+                          std::size_t rows, std::size_t cols,
+                          const int32_t* kernelX, const int32_t* kernelY) {
+    for (std::size_t row = 0; row < rows; ++row) {
+        const uint8_t* s = src + row * srcStep;
+        GradientRow(s, s + srcStep, s + 2 * srcStep, dst + row * dstStep, cols, kernelX, kernelY);
+    }
+}
+
+void GrayGradient3x3(const Mat& src, Mat& dst, const Rect& windows,
+                     const int32_t* kernelX, const int32_t* kernelY) {
+    const std::size_t grayCols = windows.width + 2;
+    StripBuffers& buffers = LocalStripBuffers();
+    buffers.gray.resize(std::max(buffers.gray.size(), (kStripRows + 2) * grayCols));
+    buffers.magnitude.resize(std::max(buffers.magnitude.size(), kStripRows * windows.width));
+
+    for (std::size_t y = 0; y < windows.height; y += kStripRows) {
+        const std::size_t rows = std::min(kStripRows, windows.height - y);
+
+        Grayscale(src.GetPtr(windows.y + y, windows.x), src.step,
+                  buffers.gray.data(), grayCols, rows + 2, grayCols);
+        GradientMagnitude3x3(buffers.gray.data(), grayCols,
+                             buffers.magnitude.data(), windows.width,
+                             rows, windows.width, kernelX, kernelY);
+
+        for (std::size_t row = 0; row < rows; ++row) {
+            const uint8_t* m = buffers.magnitude.data() + row * windows.width;
+            uint8_t* d = dst.GetPtr(windows.y + y + row + 1, windows.x + 1);
+
+            #pragma omp simd
+            for (std::size_t col = 0; col < windows.width; ++col) {
+                d[col * 3 + PixelRGB::Pos::R] = m[col];
+                d[col * 3 + PixelRGB::Pos::G] = m[col];
+                d[col * 3 + PixelRGB::Pos::B] = m[col];
+            }
+        }
+    }
+}
+
+void GrayGradient3x3(const PlanarMat& src, PlanarMat& dst, const Rect& windows,
+                     const int32_t* kernelX, const int32_t* kernelY) {
+    const std::size_t grayCols = windows.width + 2;
+    StripBuffers& buffers = LocalStripBuffers();
+    buffers.gray.resize(std::max(buffers.gray.size(), (kStripRows + 2) * grayCols));
+
+    const Plane& r = src[PixelRGB::Pos::R];
+    const Plane& g = src[PixelRGB::Pos::G];
+    const Plane& b = src[PixelRGB::Pos::B];
+
+    for (std::size_t y = 0; y < windows.height; y += kStripRows) {
+        const std::size_t rows = std::min(kStripRows, windows.height - y);
+        const std::size_t row0 = windows.y + y;
+
+        Grayscale(r.GetPtr(row0, windows.x), g.GetPtr(row0, windows.x), b.GetPtr(row0, windows.x),
+                  r.step, buffers.gray.data(), grayCols, rows + 2, grayCols);
+
+        Plane& first = dst.planes[0];
+        GradientMagnitude3x3(buffers.gray.data(), grayCols,
+                             first.GetPtr(row0 + 1, windows.x + 1), first.step,
+                             rows, windows.width, kernelX, kernelY);
+        for (std::size_t i = 1; i < dst.planes.size(); ++i) {
+            for (std::size_t row = 0; row < rows; ++row) {
+                std::copy_n(first.GetPtr(row0 + row + 1, windows.x + 1), windows.width,
+                            dst.planes[i].GetPtr(row0 + row + 1, windows.x + 1));
+            }
+        }
+    }
+}
+
+} // namespace pp
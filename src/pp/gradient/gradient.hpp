@@ -0,0 +1,52 @@
+#ifndef IMAGE_PREPROCESSING_PP_GRADIENT_HPP_
+#define IMAGE_PREPROCESSING_PP_GRADIENT_HPP_
+
+#include "pp/mat/mat.hpp"
+#include "pp/planar/planar.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace pp {
+
+// Наибольшая сумма модулей весов ядра, при которой gx*gx + gy*gy
+// гарантированно помещается в int32_t.
+constexpr int32_t kMaxGradientKernelWeight = 64;
+
+// Яркость rows x cols пикселей, побайтно равная PixelRGB::grayscale():
+// целочисленные веса 2989/5870/1141 (/10000) и точный пересчёт в double
+// только для пикселей с дробной частью ровно .5, где результат зависит
+// от округления double-весов.
+void Grayscale(const uint8_t* src, std::size_t srcStep,
+               uint8_t* dst, std::size_t dstStep,
+               std::size_t rows, std::size_t cols);
+
+// То же для трёх плоскостей R, G, B с общим шагом srcStep.
+void Grayscale(const uint8_t* r, const uint8_t* g, const uint8_t* b, std::size_t srcStep,
+               uint8_t* dst, std::size_t dstStep,
+               std::size_t rows, std::size_t cols);
+
+// Яркость всего изображения (вместе с рамкой) в одноканальное dst того же
+// размера и с той же рамкой: дальнейшие фильтры читают треть байт.
+void Grayscale(const Mat& src, Plane& dst);
+void Grayscale(const PlanarMat& src, Plane& dst);
+
+// Модуль градиента с ядрами 3x3 kernelX/kernelY по одноканальному
+// изображению: src указывает на левый верхний угол первого окна, dst - на
+// его центр, rows x cols - число окон. Результат совпадает с
+// SegmentationFilterProc, включая перенос по модулю 256 для модулей > 255.
+void GradientMagnitude3x3(const uint8_t* src, std::size_t srcStep,
+                          uint8_t* dst, std::size_t dstStep,
+                          std::size_t rows, std::size_t cols,
+                          const int32_t* kernelX, const int32_t* kernelY);
+
+// Градиент яркости для окон windows: яркость считается один раз полосами
+// строк в переиспользуемый буфер, модуль пишется во все каналы dst.
+void GrayGradient3x3(const Mat& src, Mat& dst, const Rect& windows,
+                     const int32_t* kernelX, const int32_t* kernelY);
+void GrayGradient3x3(const PlanarMat& src, PlanarMat& dst, const Rect& windows,
+                     const int32_t* kernelX, const int32_t* kernelY);
+
+} // namespace pp
+
+#endif
@@ -2,46 +2,207 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <limits>
+#include <new>
 
+#include <omp.h>
+
+#include "pp/cpu/cpu.hpp"
 #include "pp/pixel/pixel.hpp"
 
 namespace pp {
 
-// TODO: Добавить throw(except)
+namespace {
+
+template<std::size_t kChannels>
+PP_ALWAYS_INLINE void MirrorRowEdgesImpl(uint8_t* row, std::size_t cols, std::size_t borderSize) {
+    uint8_t* left = row + borderSize * kChannels;
+    uint8_t* right = row + (cols - borderSize) * kChannels;
+
+    #pragma omp simd
+    for (std::size_t j = 0; j < borderSize * kChannels; ++j) {
+        // j-й байт рамки берётся из того же канала отражённого пикселя.
+        const std::size_t pixel = j / kChannels;
+        const std::size_t channel = j % kChannels;
+        left[-static_cast<std::ptrdiff_t>((pixel + 1) * kChannels) + channel] = left[j];
+        right[j] = right[-static_cast<std::ptrdiff_t>((pixel + 1) * kChannels) + channel];
+    }
+}
+
+PP_ALWAYS_INLINE void MirrorRowEdgesChannels(uint8_t* row, std::size_t cols,
+                                             std::size_t borderSize, std::size_t channels) {
+    if (channels == 3) {
+        MirrorRowEdgesImpl<3>(row, cols, borderSize);
+    } else {
+        MirrorRowEdgesImpl<1>(row, cols, borderSize);
+    }
+}
+
+PP_CPU_VARIANTS(void, MirrorRowEdges, MirrorRowEdgesChannels,
+                (uint8_t* row, std::size_t cols, std::size_t borderSize, std::size_t channels),
+                (row, cols, borderSize, channels))
+
+// Строки [0, rows) делятся на непрерывные полосы по потокам команды, как
+// окна в ParallelDoFilter.
+template<class RowFunc>
+void ForEachRowStrip(std::size_t rows, RowFunc rowFunc) {
+    #pragma omp parallel
+    {
+        const std::size_t threads = omp_get_num_threads();
+        const std::size_t id = omp_get_thread_num();
+        const std::size_t begin = rows * id / threads;
+        const std::size_t end = rows * (id + 1) / threads;
+
+        for (std::size_t row = begin; row < end; ++row) {
+            rowFunc(row);
+        }
+    }
+}
+
+} // namespace
+
+void MirrorRowEdges(uint8_t* row, std::size_t cols, std::size_t borderSize, std::size_t channels) {
+    PP_CPU_DISPATCH(MirrorRowEdges, (row, cols, borderSize, channels));
+}
+
+std::size_t AlignUp(std::size_t value, std::size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+std::size_t AlignedBytes(std::size_t count, std::size_t size) {
+    constexpr std::size_t kMax = std::numeric_limits<std::size_t>::max() - kRowAlignment;
+    if (size != 0 && count > kMax / size) {
+        throw std::bad_alloc();
+    }
+
+    return AlignUp(count * size, kRowAlignment);
+}
+
+uint8_t* AllocAligned(std::size_t size) {
+    if (size == 0) {
+        return nullptr;
+    }
+#ifdef _MSC_VER
+    void* p = _aligned_malloc(size, kRowAlignment);
+#else
+    void* p = std::aligned_alloc(kRowAlignment, AlignedBytes(size, 1));
+#endif
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    return static_cast<uint8_t*>(p);
+}
+
+void FreeAligned(uint8_t* p) {
+#ifdef _MSC_VER
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+Mat::Mat(std::size_t rows, std::size_t cols)
+    : rows{rows}, cols{cols}, step{AlignedBytes(cols, 3)},
+      buffer_{AllocAligned(AlignedBytes(rows, step)), FreeAligned} {
+    data = buffer_.get();
+}
+
+Mat::Mat(std::size_t rows, std::size_t cols, std::size_t borderSize, Placement placement)
+    : Mat{rows, cols, borderSize} {
+    if (placement == Placement::kFirstTouch) {
+        ForEachRowStrip(rows, [this](std::size_t row) { std::memset(GetPtr(row, 0), 0, step); });
+    }
+}
+
+Mat::Mat(const Mat& other, Placement placement): Mat{other.rows, other.cols, other.borderSize} {
+    if (placement == Placement::kFirstTouch) {
+        CopyRowStrips(other, *this);
+    } else {
+        for (std::size_t row = 0; row < rows; ++row) {
+            std::memcpy(GetPtr(row, 0), other.GetPtr(row, 0), cols * 3);
+        }
+    }
+}
+
+void CopyRowStrips(const Mat& src, Mat& dst) {
+    ForEachRowStrip(src.rows, [&src, &dst](std::size_t row) {
+        std::memcpy(dst.GetPtr(row, 0), src.GetPtr(row, 0), src.cols * 3);
+    });
+}
 
 Mat::Mat(std::size_t rows, std::size_t cols, const unsigned char* data): Mat{rows, cols} {
-    std::memcpy(this->data, data, rows*cols*3);
+    for (std::size_t row = 0; row < rows; ++row) {
+        std::memcpy(GetPtr(row, 0), data + row * cols * 3, cols * 3);
+    }
 }
 
-Mat::Mat(std::size_t rows, std::size_t cols, unsigned char* data): rows(rows), cols(cols), data(data) {}
+Mat::Mat(std::size_t rows, std::size_t cols, std::size_t step, unsigned char* data, Ownership ownership)
+    : rows(rows), cols(cols), step(step), data(data) {
+    if (ownership == Ownership::kAdopt) {
+        buffer_ = std::shared_ptr<uint8_t>(data, std::default_delete<uint8_t[]>());
+    }
+}
 
-Mat::Mat()
-    : rows{0}, cols{0}, data{nullptr} {}
+Mat::Mat(std::size_t rows, std::size_t cols, std::size_t step, unsigned char* data,
+         std::function<void(uint8_t*)> release)
+    : rows(rows), cols(cols), step(step), data(data), buffer_(data, std::move(release)) {}
 
-Mat::~Mat(){
-    if(data != nullptr) {
-        delete [] data;
+Mat::Mat(const Mat& other): Mat{other.rows, other.cols} {
+    borderSize = other.borderSize;
+    for (std::size_t row = 0; row < rows; ++row) {
+        std::memcpy(GetPtr(row, 0), other.GetPtr(row, 0), cols * 3);
     }
 }
 
+Mat::Mat()
+    : rows{0}, cols{0}, step{0}, data{nullptr} {}
+
+Mat::~Mat() = default;
+
+bool Mat::OwnsAlignedBuffer() const {
+    using Deleter = void (*)(uint8_t*);
+
+    const Deleter* deleter = std::get_deleter<Deleter>(buffer_);
+    return deleter != nullptr && *deleter == FreeAligned && buffer_.use_count() == 1 &&
+           data == buffer_.get() && step == AlignedBytes(cols, 3);
+}
+
+Mat Mat::Crop(const Rect& rect) {
+    Mat result;
+    result.rows = rect.height;
+    result.cols = rect.width;
+    result.step = step;
+    result.data = GetPtr(rect.y, rect.x);
+    result.buffer_ = buffer_;
+
+    return result;
+}
+
 bool Mat::operator==(const Mat& other) const {
     if (rows != other.rows || cols != other.cols) {
         return false;
     }
     
-    if (data == other.data) {
+    if (data == other.data && step == other.step) {
         return true;
     }
-    const size_t totalPixels = rows * cols * 3;
-    return std::memcmp(data, other.data, totalPixels) == 0;
+
+    for (std::size_t row = 0; row < rows; ++row) {
+        if (std::memcmp(GetPtr(row, 0), other.GetPtr(row, 0), cols * 3) != 0) {
+            return false;
+        }
+    }
+    return true;
 }
 uint8_t* Mat::GetPtr(std::size_t row, std::size_t col) {
-    return data + (cols * row + col) * 3;
+    return data + row * step + col * 3;
 }
 
 const uint8_t* Mat::GetPtr(std::size_t row, std::size_t col) const {
-    return data + (cols * row + col) * 3;
+    return data + row * step + col * 3;
 }
 
 PixelRGB Mat::GetPixel(std::size_t row, std::size_t col) const {
@@ -73,10 +234,7 @@ Mat Mat::CopyWithBorder(std::size_t borderSize) {
     result.borderSize = borderSize;
 
     for (std::size_t i = 0; i < rows; ++i) {
-        for (std::size_t j = 0; j < cols; ++j) {
-            auto p = GetPixel(i, j);
-            result.SetPixel(i + borderSize, j + borderSize, p);
-        }
+        std::memcpy(result.GetPtr(i + borderSize, borderSize), GetPtr(i, 0), cols * 3);
     }
 
     return result;
@@ -90,10 +248,7 @@ Mat Mat::ResetBorder() {
     Mat result(rows - borderSize*2, cols - borderSize*2);
 
     for (std::size_t i = 0; i < result.rows; ++i) {
-        for (std::size_t j = 0; j < result.cols; ++j) {
-            auto p = GetPixel(i + borderSize, j + borderSize);
-            result.SetPixel(i, j, p);
-        }
+        std::memcpy(result.GetPtr(i, 0), GetPtr(i + borderSize, borderSize), result.cols * 3);
     }
 
     return result;
@@ -229,8 +384,16 @@ void Mat::MirrorCorners(std::size_t borderSize) {
 }
 
 void Mat::MakeMirrorBorder(std::size_t borderSize) {
-    MirrorEdges(borderSize);
-    MirrorCorners(borderSize);
+    // Результат тот же, что у MirrorEdges + MirrorCorners: левый и правый
+    // края внутренних строк, затем верх и низ целыми строками (вместе с углами).
+    for (std::size_t row = borderSize; row < rows - borderSize; ++row) {
+        MirrorRowEdges(GetPtr(row, 0), cols, borderSize, 3);
+    }
+
+    for (std::size_t i = 0; i < borderSize; ++i) {
+        std::memcpy(GetPtr(borderSize - 1 - i, 0), GetPtr(borderSize + i, 0), cols * 3);
+        std::memcpy(GetPtr(rows - borderSize + i, 0), GetPtr(rows - borderSize - 1 - i, 0), cols * 3);
+    }
 }
 
 uint8_t* ROI::GetPtr(std::size_t row, std::size_t col) {
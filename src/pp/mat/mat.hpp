@@ -7,11 +7,31 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
+#include <functional>
 #include <inttypes.h>
+#include <memory>
 #include <utility>
 
 namespace pp {
 
+// Выравнивание начала строк изображений (кэш-линия / ширина AVX-512).
+constexpr std::size_t kRowAlignment = 64;
+
+std::size_t AlignUp(std::size_t value, std::size_t alignment);
+
+// count * size байт, дополненные до кратного kRowAlignment; если это не
+// помещается в size_t, бросает std::bad_alloc (как new[] с огромным размером).
+std::size_t AlignedBytes(std::size_t count, std::size_t size);
+
+// Память, выровненная на kRowAlignment; освобождается FreeAligned. Если
+// памяти нет, бросает std::bad_alloc.
+uint8_t* AllocAligned(std::size_t size);
+void FreeAligned(uint8_t* p);
+
+// Отражает borderSize крайних пикселей строки в её левую и правую рамку;
+// cols - ширина строки вместе с рамкой, channels - байт на пиксель.
+void MirrorRowEdges(uint8_t* row, std::size_t cols, std::size_t borderSize, std::size_t channels);
+
 template <std::size_t N>
 struct Vec {
     uint8_t operator[](std::size_t idx);
@@ -29,13 +49,34 @@ struct Rect {
     std::size_t height = 0;
 };
 
+class Mat;
+
+// Копирует src в dst того же размера; строки пишет команда потоков OpenMP
+// полосами, как при Mat::Placement::kFirstTouch. Вызывается вне
+// параллельных областей.
+void CopyRowStrips(const Mat& src, Mat& dst);
+
 class Mat {
 public:
+    // Кто отвечает за внешний буфер, переданный в Mat.
+    enum class Ownership {
+        kBorrow, // буфер остаётся у вызывающего и должен пережить Mat и его окна
+        kAdopt,  // Mat освобождает буфер через delete[]
+    };
+
+    // На каком узле NUMA окажутся страницы нового буфера.
+    enum class Placement {
+        kDefault,    // там, где страницу впервые запишут
+        kFirstTouch, // строки сразу записывает команда потоков OpenMP теми же
+                     // полосами, что ParallelDoFilter и schedule(static):
+                     // полоса лежит на узле потока, который её фильтрует
+    };
+
     Mat();
 
     ~Mat();
 
-    Mat(const Mat& other): Mat(other.rows, other.cols, (const unsigned char*) other.data) { borderSize = other.borderSize; }
+    Mat(const Mat& other);
     Mat(Mat&& other): Mat() {
         other.swap(*this);
     }
@@ -57,8 +98,10 @@ public:
 
         swap(rows, other.rows);
         swap(cols, other.cols);
+        swap(step, other.step);
         swap(data, other.data);
         swap(borderSize, other.borderSize);
+        swap(buffer_, other.buffer_);
     }
 
     bool operator==(const Mat& other) const;
@@ -68,16 +111,37 @@ public:
         return !(*this == other);
     }
 
-    Mat(std::size_t rows, std::size_t cols)
-    : rows{rows}, cols{cols}, data{new uint8_t[rows*cols*3]} {}
+    // Строки выровнены на kRowAlignment байт, step дополнен до кратного.
+    Mat(std::size_t rows, std::size_t cols);
 
     Mat(std::size_t rows, std::size_t cols, std::size_t borderSize): Mat{rows, cols} {
         this->borderSize = borderSize;
     }
 
+    // С kFirstTouch буфер обнуляется полосами строк; вызывается вне
+    // параллельных областей.
+    Mat(std::size_t rows, std::size_t cols, std::size_t borderSize, Placement placement);
+
+    // Копия other, строки которой пишет (и тем размещает) placement.
+    Mat(const Mat& other, Placement placement);
+
+    // Копирует плотно упакованные (step == cols * 3) данные.
     Mat(std::size_t rows, std::size_t cols, const unsigned char* data);
 
-    Mat(std::size_t rows, std::size_t cols, unsigned char* data);
+    // Внешний буфер без копирования.
+    Mat(std::size_t rows, std::size_t cols, std::size_t step, unsigned char* data, Ownership ownership);
+
+    // Внешний буфер без копирования; release вызывается, когда буфер больше
+    // не нужен ни Mat, ни его окнам (например, чтобы отпустить cv::Mat).
+    Mat(std::size_t rows, std::size_t cols, std::size_t step, unsigned char* data,
+        std::function<void(uint8_t*)> release);
+
+    // Окно rect без копирования: общий с исходным Mat буфер и тот же step.
+    Mat Crop(const Rect& rect);
+
+    // Целое изображение в собственном буфере, выделенном Mat(rows, cols), и
+    // ни одно окно на этот буфер не ссылается: буфер можно переиспользовать.
+    bool OwnsAlignedBuffer() const;
 
 
     PixelRGB GetPixel(std::size_t row, std::size_t col) const;
@@ -110,8 +174,12 @@ public:
 
     std::size_t rows;
     std::size_t cols;
+    std::size_t step; // байт между началами соседних строк
     uint8_t* data;
     std::size_t borderSize = 0;
+
+private:
+    std::shared_ptr<uint8_t> buffer_;
 };
 
 class ROI {
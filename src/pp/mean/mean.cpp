@@ -0,0 +1,119 @@
+#include "pp/mean/mean.hpp"
+#include "pp/cpu/cpu.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace pp {
+namespace {
+
+// Деление на area умножением на обратное: (n * m) >> 32 == n / area,
+// пока n * area < 2^32. Для n <= 255 * area это окна до 64x64.
+class Divider {
+public:
+    explicit Divider(uint32_t area)
+     : area_{area},
+       multiplier_{(uint64_t{1} << 32) / area + 1},
+       exact_{uint64_t{255} * area * area < (uint64_t{1} << 32)} {}
+
+    uint8_t operator()(uint32_t n) const {
+        if (exact_) {
+            return static_cast<uint8_t>((n * multiplier_) >> 32);
+        }
+        return static_cast<uint8_t>(n / area_);
+    }
+
+private:
+    uint32_t area_;
+    uint64_t multiplier_;
+    bool exact_;
+};
+
+PP_ALWAYS_INLINE void BoxMeanImpl(const uint8_t* src, std::size_t srcStep,
+                                   uint8_t* dst, std::size_t dstStep,
+                                   std::size_t rows, std::size_t cols,
+                                   std::size_t channels, std::size_t kernelSize) {
+    const std::size_t width = (cols + kernelSize - 1) * channels;
+    const std::size_t span = kernelSize * channels;
+    const Divider div(kernelSize * kernelSize);
+
+    std::vector<uint32_t> colSum(width, 0);
+    for (std::size_t dy = 0; dy < kernelSize; ++dy) {
+        const uint8_t* s = src + dy * srcStep;
+        for (std::size_t j = 0; j < width; ++j) {
+            colSum[j] += s[j];
+        }
+    }
+
+    for (std::size_t row = 0; row < rows; ++row) {
+        uint8_t* d = dst + row * dstStep;
+
+        // Горизонтальный проход: сумма окна сдвигается на один пиксель,
+        // прибавляя входящий столбец и вычитая выходящий.
+        for (std::size_t ch = 0; ch < channels; ++ch) {
+            uint32_t sum = 0;
+            for (std::size_t j = ch; j < span; j += channels) {
+                sum += colSum[j];
+            }
+
+            d[ch] = div(sum);
+            for (std::size_t j = ch + channels; j < cols * channels; j += channels) {
+                sum += colSum[j + span - channels] - colSum[j - channels];
+                d[j] = div(sum);
+            }
+        }
+
+        // Вертикальный сдвиг: строка row уходит из окна, row + kernelSize входит.
+        if (row + 1 < rows) {
+            const uint8_t* out = src + row * srcStep;
+            const uint8_t* in = src + (row + kernelSize) * srcStep;
+            for (std::size_t j = 0; j < width; ++j) {
+                colSum[j] += in[j];
+                colSum[j] -= out[j];
+            }
+        }
+    }
+}
+
+PP_CPU_VARIANTS(void, BoxMean, BoxMeanImpl,
+                (const uint8_t* src, std::size_t srcStep, uint8_t* dst, std::size_t dstStep,
+                 std::size_t rows, std::size_t cols, std::size_t channels, std::size_t kernelSize),
+                (src, srcStep, dst, dstStep, rows, cols, channels, kernelSize))
+
+} // namespace
+
+void BoxMean(const uint8_t* src, std::size_t srcStep,
+             uint8_t* dst, std::size_t dstStep,
+             std::size_t rows, std::size_t cols,
+             std::size_t channels, std::size_t kernelSize) {
+    if (rows == 0 || cols == 0) {
+        return;
+    }
+
+    PP_CPU_DISPATCH(BoxMean, (src, srcStep, dst, dstStep, rows, cols, channels, kernelSize));
+}
+
+void BoxMeanFilterProc::ProcessBlock(Mat& src, Mat& dst, const Rect& windows) const {
+    if (windows.width == 0 || windows.height == 0) {
+        return;
+    }
+
+    const std::size_t half_k = kernelSize / 2;
+    BoxMean(src.GetPtr(windows.y, windows.x), src.step,
+            dst.GetPtr(windows.y + half_k, windows.x + half_k), dst.step,
+            windows.height, windows.width, 3, kernelSize);
+}
+
+void BoxMeanFilterProc::ProcessBlock(Plane& src, Plane& dst, const Rect& windows) const {
+    if (windows.width == 0 || windows.height == 0) {
+        return;
+    }
+
+    const std::size_t half_k = kernelSize / 2;
+    BoxMean(src.GetPtr(windows.y, windows.x), src.step,
+            dst.GetPtr(windows.y + half_k, windows.x + half_k), dst.step,
+            windows.height, windows.width, 1, kernelSize);
+}
+
+} // namespace pp
@@ -0,0 +1,34 @@
+#ifndef IMAGE_PREPROCESSING_PP_MEAN_HPP_
+#define IMAGE_PREPROCESSING_PP_MEAN_HPP_
+
+#include "pp/mat/mat.hpp"
+#include "pp/planar/planar.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace pp {
+
+// Усреднение по окну kernelSize x kernelSize на скользящих суммах:
+// суммы по столбцам обновляются при сдвиге окна вниз, сумма окна - при сдвиге
+// вправо, поэтому стоимость на пиксель не зависит от kernelSize.
+// src указывает на левый верхний угол первого окна, dst - на его центр;
+// rows x cols - число окон, channels - число чередующихся каналов.
+// Результат совпадает с MeanFilterProc (целочисленное sum / area).
+void BoxMean(const uint8_t* src, std::size_t srcStep,
+             uint8_t* dst, std::size_t dstStep,
+             std::size_t rows, std::size_t cols,
+             std::size_t channels, std::size_t kernelSize);
+
+class BoxMeanFilterProc {
+public:
+    BoxMeanFilterProc(std::size_t kernelSize): kernelSize(kernelSize) {}
+    void ProcessBlock(Mat& src, Mat& dst, const Rect& windows) const;
+    void ProcessBlock(Plane& src, Plane& dst, const Rect& windows) const;
+
+    std::size_t kernelSize;
+};
+
+} // namespace pp
+
+#endif
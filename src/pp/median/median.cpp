@@ -0,0 +1,324 @@
+#include "pp/median/median.hpp"
+#include "pp/cpu/cpu.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace pp {
+namespace {
+
+constexpr std::size_t kBins = 256;
+constexpr std::size_t kCoarseBins = 16;
+constexpr std::size_t kFineBins = kBins / kCoarseBins;
+
+// Гистограммы столбцов: точные и грубые бины для каждого отсчёта строки.
+class ColumnHistograms {
+public:
+    explicit ColumnHistograms(std::size_t width)
+     : fine_(width * kBins, 0), coarse_(width * kCoarseBins, 0) {}
+
+    void Add(const uint8_t* row, std::size_t width) {
+        for (std::size_t j = 0; j < width; ++j) {
+            ++fine_[j * kBins + row[j]];
+            ++coarse_[j * kCoarseBins + row[j] / kFineBins];
+        }
+    }
+
+    void Remove(const uint8_t* row, std::size_t width) {
+        for (std::size_t j = 0; j < width; ++j) {
+            --fine_[j * kBins + row[j]];
+            --coarse_[j * kCoarseBins + row[j] / kFineBins];
+        }
+    }
+
+    const uint16_t* Fine(std::size_t j, std::size_t coarseBin) const {
+        return &fine_[j * kBins + coarseBin * kFineBins];
+    }
+
+    const uint16_t* Coarse(std::size_t j) const {
+        return &coarse_[j * kCoarseBins];
+    }
+
+private:
+    std::vector<uint16_t> fine_;
+    std::vector<uint16_t> coarse_;
+};
+
+// Гистограмма окна для одного канала одной строки результата.
+class KernelHistogram {
+public:
+    KernelHistogram(const ColumnHistograms& columns, std::size_t channels, std::size_t kernelSize)
+     : columns_{columns}, channels_{channels}, kernelSize_{kernelSize} {}
+
+    void Reset(std::size_t channel) {
+        channel_ = channel;
+        coarse_.fill(0);
+        lastCol_.fill(kStale);
+        for (std::size_t dx = 0; dx < kernelSize_; ++dx) {
+            Add(coarse_.data(), columns_.Coarse(Sample(dx)), kCoarseBins);
+        }
+    }
+
+    // Сдвигает окно из col - 1 в col (только грубые бины).
+    void Shift(std::size_t col) {
+        Add(coarse_.data(), columns_.Coarse(Sample(col + kernelSize_ - 1)), kCoarseBins);
+        Sub(coarse_.data(), columns_.Coarse(Sample(col - 1)), kCoarseBins);
+    }
+
+    uint8_t Median(std::size_t col, uint32_t rank) {
+        uint32_t acc = 0;
+        std::size_t c = 0;
+        while (acc + coarse_[c] <= rank) {
+            acc += coarse_[c];
+            ++c;
+        }
+
+        uint16_t* fine = UpdateFine(c, col);
+        std::size_t f = 0;
+        while (acc + fine[f] <= rank) {
+            acc += fine[f];
+            ++f;
+        }
+
+        return static_cast<uint8_t>(c * kFineBins + f);
+    }
+
+private:
+    static constexpr std::size_t kStale = std::numeric_limits<std::size_t>::max();
+
+    std::size_t Sample(std::size_t col) const { return col * channels_ + channel_; }
+
+    static void Add(uint16_t* dst, const uint16_t* src, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            dst[i] += src[i];
+        }
+    }
+
+    static void Sub(uint16_t* dst, const uint16_t* src, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            dst[i] -= src[i];
+        }
+    }
+
+    // Доводит точные бины грубого бина c до окна, начинающегося в col.
+    uint16_t* UpdateFine(std::size_t c, std::size_t col) {
+        uint16_t* fine = fine_[c].data();
+
+        if (lastCol_[c] == kStale || col - lastCol_[c] >= kernelSize_) {
+            fine_[c].fill(0);
+            for (std::size_t dx = 0; dx < kernelSize_; ++dx) {
+                Add(fine, columns_.Fine(Sample(col + dx), c), kFineBins);
+            }
+        } else {
+            for (std::size_t x = lastCol_[c]; x < col; ++x) {
+                Add(fine, columns_.Fine(Sample(x + kernelSize_), c), kFineBins);
+                Sub(fine, columns_.Fine(Sample(x), c), kFineBins);
+            }
+        }
+
+        lastCol_[c] = col;
+        return fine;
+    }
+
+    const ColumnHistograms& columns_;
+    std::size_t channels_;
+    std::size_t kernelSize_;
+    std::size_t channel_ = 0;
+
+    std::array<uint16_t, kCoarseBins> coarse_;
+    std::array<std::array<uint16_t, kFineBins>, kCoarseBins> fine_;
+    std::array<std::size_t, kCoarseBins> lastCol_;
+};
+
+// Число соседних отсчётов, обрабатываемых сетью за один проход.
+constexpr std::size_t kLanes = 64;
+
+using Comparator = std::pair<uint8_t, uint8_t>;
+
+// Сети из "Fast median search: an ANSI C implementation" (N. Devillard),
+// после них медиана окна лежит в элементе K*K/2.
+constexpr std::array<Comparator, 19> kNetwork3x3 = {{
+    {1, 2}, {4, 5}, {7, 8}, {0, 1}, {3, 4}, {6, 7}, {1, 2}, {4, 5}, {7, 8}, {0, 3},
+    {5, 8}, {4, 7}, {3, 6}, {1, 4}, {2, 5}, {4, 7}, {4, 2}, {6, 4}, {4, 2},
+}};
+
+constexpr std::array<Comparator, 99> kNetwork5x5 = {{
+    {0, 1}, {3, 4}, {2, 4}, {2, 3}, {6, 7}, {5, 7}, {5, 6}, {9, 10}, {8, 10}, {8, 9},
+    {12, 13}, {11, 13}, {11, 12}, {15, 16}, {14, 16}, {14, 15}, {18, 19}, {17, 19}, {17, 18}, {21, 22},
+    {20, 22}, {20, 21}, {23, 24}, {2, 5}, {3, 6}, {0, 6}, {0, 3}, {4, 7}, {1, 7}, {1, 4},
+    {11, 14}, {8, 14}, {8, 11}, {12, 15}, {9, 15}, {9, 12}, {13, 16}, {10, 16}, {10, 13}, {20, 23},
+    {17, 23}, {17, 20}, {21, 24}, {18, 24}, {18, 21}, {19, 22}, {8, 17}, {9, 18}, {0, 18}, {0, 9},
+    {10, 19}, {1, 19}, {1, 10}, {11, 20}, {2, 20}, {2, 11}, {12, 21}, {3, 21}, {3, 12}, {13, 22},
+    {4, 22}, {4, 13}, {14, 23}, {5, 23}, {5, 14}, {15, 24}, {6, 24}, {6, 15}, {7, 16}, {7, 19},
+    {13, 21}, {15, 23}, {7, 13}, {7, 15}, {1, 9}, {3, 11}, {5, 17}, {11, 17}, {9, 17}, {4, 10},
+    {6, 12}, {7, 14}, {4, 6}, {4, 7}, {12, 14}, {10, 14}, {6, 7}, {10, 12}, {6, 10}, {6, 17},
+    {12, 17}, {7, 17}, {7, 10}, {12, 18}, {7, 12}, {10, 18}, {12, 20}, {10, 20}, {10, 12},
+}};
+
+template<std::size_t K>
+constexpr const auto& Network() {
+    if constexpr (K == 3) {
+        return kNetwork3x3;
+    } else {
+        return kNetwork5x5;
+    }
+}
+
+// Медианы для n <= kLanes соседних отсчётов строки, начиная с src.
+// Сеть всегда прогоняется на всех kLanes дорожках: фиксированная длина
+// цикла без проверок позволяет компилятору его векторизовать.
+template<std::size_t K>
+PP_ALWAYS_INLINE void NetworkMedianLanes(const uint8_t* src, std::size_t srcStep, uint8_t* dst,
+                                         std::size_t n, std::size_t channels) {
+    uint8_t v[K * K][kLanes];
+
+    for (std::size_t dy = 0; dy < K; ++dy) {
+        for (std::size_t dx = 0; dx < K; ++dx) {
+            uint8_t* lane = v[dy * K + dx];
+            std::memcpy(lane, src + dy * srcStep + dx * channels, n);
+            std::memset(lane + n, 0, kLanes - n);
+        }
+    }
+
+    for (const auto& [a, b] : Network<K>()) {
+        uint8_t* lo = v[a];
+        uint8_t* hi = v[b];
+        #pragma omp simd
+        for (std::size_t l = 0; l < kLanes; ++l) {
+            const uint8_t x = std::min(lo[l], hi[l]);
+            const uint8_t y = std::max(lo[l], hi[l]);
+            lo[l] = x;
+            hi[l] = y;
+        }
+    }
+
+    std::memcpy(dst, v[K * K / 2], n);
+}
+
+template<std::size_t K>
+PP_ALWAYS_INLINE void NetworkMedianImpl(const uint8_t* src, std::size_t srcStep,
+                                        uint8_t* dst, std::size_t dstStep,
+                                        std::size_t rows, std::size_t cols,
+                                        std::size_t channels) {
+    const std::size_t width = cols * channels;
+
+    for (std::size_t row = 0; row < rows; ++row) {
+        const uint8_t* s = src + row * srcStep;
+        uint8_t* d = dst + row * dstStep;
+
+        for (std::size_t j = 0; j < width; j += kLanes) {
+            const std::size_t n = std::min(kLanes, width - j);
+            NetworkMedianLanes<K>(s + j, srcStep, d + j, n, channels);
+        }
+    }
+}
+
+PP_CPU_VARIANTS(void, NetworkMedian3, NetworkMedianImpl<3>,
+                (const uint8_t* src, std::size_t srcStep, uint8_t* dst, std::size_t dstStep,
+                 std::size_t rows, std::size_t cols, std::size_t channels),
+                (src, srcStep, dst, dstStep, rows, cols, channels))
+
+PP_CPU_VARIANTS(void, NetworkMedian5, NetworkMedianImpl<5>,
+                (const uint8_t* src, std::size_t srcStep, uint8_t* dst, std::size_t dstStep,
+                 std::size_t rows, std::size_t cols, std::size_t channels),
+                (src, srcStep, dst, dstStep, rows, cols, channels))
+
+PP_ALWAYS_INLINE void HistogramMedianImpl(const uint8_t* src, std::size_t srcStep,
+                                          uint8_t* dst, std::size_t dstStep,
+                                          std::size_t rows, std::size_t cols,
+                                          std::size_t channels, std::size_t kernelSize) {
+    const std::size_t width = (cols + kernelSize - 1) * channels;
+    // Тот же элемент, что выбирает std::nth_element в MedianFilterProc.
+    const uint32_t rank = kernelSize * kernelSize / 2;
+
+    ColumnHistograms columns(width);
+    for (std::size_t dy = 0; dy < kernelSize; ++dy) {
+        columns.Add(src + dy * srcStep, width);
+    }
+
+    KernelHistogram kernel(columns, channels, kernelSize);
+
+    for (std::size_t row = 0; row < rows; ++row) {
+        uint8_t* d = dst + row * dstStep;
+
+        for (std::size_t ch = 0; ch < channels; ++ch) {
+            kernel.Reset(ch);
+            d[ch] = kernel.Median(0, rank);
+
+            for (std::size_t col = 1; col < cols; ++col) {
+                kernel.Shift(col);
+                d[col * channels + ch] = kernel.Median(col, rank);
+            }
+        }
+
+        if (row + 1 < rows) {
+            columns.Remove(src + row * srcStep, width);
+            columns.Add(src + (row + kernelSize) * srcStep, width);
+        }
+    }
+}
+
+PP_CPU_VARIANTS(void, HistogramMedian, HistogramMedianImpl,
+                (const uint8_t* src, std::size_t srcStep, uint8_t* dst, std::size_t dstStep,
+                 std::size_t rows, std::size_t cols, std::size_t channels, std::size_t kernelSize),
+                (src, srcStep, dst, dstStep, rows, cols, channels, kernelSize))
+
+} // namespace
+
+template<std::size_t K>
+void NetworkMedian(const uint8_t* src, std::size_t srcStep,
+                   uint8_t* dst, std::size_t dstStep,
+                   std::size_t rows, std::size_t cols,
+                   std::size_t channels) {
+    if constexpr (K == 3) {
+        PP_CPU_DISPATCH(NetworkMedian3, (src, srcStep, dst, dstStep, rows, cols, channels));
+    } else {
+        PP_CPU_DISPATCH(NetworkMedian5, (src, srcStep, dst, dstStep, rows, cols, channels));
+    }
+}
+
+template void NetworkMedian<3>(const uint8_t*, std::size_t, uint8_t*, std::size_t,
+                               std::size_t, std::size_t, std::size_t);
+template void NetworkMedian<5>(const uint8_t*, std::size_t, uint8_t*, std::size_t,
+                               std::size_t, std::size_t, std::size_t);
+
+void HistogramMedian(const uint8_t* src, std::size_t srcStep,
+                     uint8_t* dst, std::size_t dstStep,
+                     std::size_t rows, std::size_t cols,
+                     std::size_t channels, std::size_t kernelSize) {
+    if (rows == 0 || cols == 0) {
+        return;
+    }
+
+    PP_CPU_DISPATCH(HistogramMedian, (src, srcStep, dst, dstStep, rows, cols, channels, kernelSize));
+}
+
+void HistogramMedianFilterProc::ProcessBlock(Mat& src, Mat& dst, const Rect& windows) const {
+    if (windows.width == 0 || windows.height == 0) {
+        return;
+    }
+
+    const std::size_t half_k = kernelSize / 2;
+    HistogramMedian(src.GetPtr(windows.y, windows.x), src.step,
+                    dst.GetPtr(windows.y + half_k, windows.x + half_k), dst.step,
+                    windows.height, windows.width, 3, kernelSize);
+}
+
+void HistogramMedianFilterProc::ProcessBlock(Plane& src, Plane& dst, const Rect& windows) const {
+    if (windows.width == 0 || windows.height == 0) {
+        return;
+    }
+
+    const std::size_t half_k = kernelSize / 2;
+    HistogramMedian(src.GetPtr(windows.y, windows.x), src.step,
+                    dst.GetPtr(windows.y + half_k, windows.x + half_k), dst.step,
+                    windows.height, windows.width, 1, kernelSize);
+}
+
+} // namespace pp
@@ -0,0 +1,77 @@
+#ifndef IMAGE_PREPROCESSING_PP_MEDIAN_HPP_
+#define IMAGE_PREPROCESSING_PP_MEDIAN_HPP_
+
+#include "pp/mat/mat.hpp"
+#include "pp/planar/planar.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace pp {
+
+// Начиная с этого размера окна гистограммный медианный фильтр быстрее
+// MedianFilterProc.
+constexpr std::size_t kHistogramMedianMinKernelSize = 3;
+
+// Медианный фильтр Perreault-Hebert: для каждого столбца хранится гистограмма
+// по kernelSize строкам (256 точных + 16 грубых бинов), гистограмма окна
+// сдвигается вправо сложением/вычитанием гистограмм столбцов, а точные бины
+// окна обновляются лениво, только для грубого бина с медианой.
+// Стоимость на пиксель не зависит от kernelSize.
+// Параметры как у BoxMean. Результат совпадает с MedianFilterProc.
+void HistogramMedian(const uint8_t* src, std::size_t srcStep,
+                     uint8_t* dst, std::size_t dstStep,
+                     std::size_t rows, std::size_t cols,
+                     std::size_t channels, std::size_t kernelSize);
+
+class HistogramMedianFilterProc {
+public:
+    HistogramMedianFilterProc(std::size_t kernelSize): kernelSize(kernelSize) {}
+    void ProcessBlock(Mat& src, Mat& dst, const Rect& windows) const;
+    void ProcessBlock(Plane& src, Plane& dst, const Rect& windows) const;
+
+    std::size_t kernelSize;
+};
+
+// Медиана сортирующей сетью из min/max для окон 3x3 (19 сравнений) и
+// 5x5 (99 сравнений). Сеть применяется сразу к блоку соседних отсчётов
+// строки, поэтому min/max компилируются в векторные инструкции.
+// Параметры как у BoxMean. Результат совпадает с MedianFilterProc.
+template<std::size_t K>
+void NetworkMedian(const uint8_t* src, std::size_t srcStep,
+                   uint8_t* dst, std::size_t dstStep,
+                   std::size_t rows, std::size_t cols,
+                   std::size_t channels);
+
+template<std::size_t K>
+class NetworkMedianFilterProc {
+    static_assert(K == 3 || K == 5, "NetworkMedianFilterProc supports 3x3 and 5x5 kernels");
+public:
+    void ProcessBlock(Mat& src, Mat& dst, const Rect& windows) const {
+        if (windows.width == 0 || windows.height == 0) {
+            return;
+        }
+
+        const std::size_t half_k = kernelSize / 2;
+        NetworkMedian<K>(src.GetPtr(windows.y, windows.x), src.step,
+                         dst.GetPtr(windows.y + half_k, windows.x + half_k), dst.step,
+                         windows.height, windows.width, 3);
+    }
+
+    void ProcessBlock(Plane& src, Plane& dst, const Rect& windows) const {
+        if (windows.width == 0 || windows.height == 0) {
+            return;
+        }
+
+        const std::size_t half_k = kernelSize / 2;
+        NetworkMedian<K>(src.GetPtr(windows.y, windows.x), src.step,
+                         dst.GetPtr(windows.y + half_k, windows.x + half_k), dst.step,
+                         windows.height, windows.width, 1);
+    }
+
+    static constexpr std::size_t kernelSize = K;
+};
+
+} // namespace pp
+
+#endif
@@ -0,0 +1,108 @@
+#include "pp/median/median.hpp"
+
+#include "pp/cpu/cpu.hpp"
+#include "pp/transformation/transformation.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+
+namespace {
+
+constexpr pp::CpuLevel kLevels[] = {
+    pp::CpuLevel::kScalar, pp::CpuLevel::kSse41, pp::CpuLevel::kAvx2, pp::CpuLevel::kAvx512,
+};
+
+pp::Mat RandomMat(std::size_t rows, std::size_t cols, std::mt19937& rng) {
+    std::uniform_int_distribution<int> value(0, 255);
+    pp::Mat img(rows, cols);
+    for (std::size_t row = 0; row < rows; ++row) {
+        for (std::size_t j = 0; j < cols * 3; ++j) {
+            img.GetPtr(row, 0)[j] = static_cast<uint8_t>(value(rng));
+        }
+    }
+    return img;
+}
+
+// Медиана по определению для всех окон кадра.
+pp::Mat ReferenceMedian(pp::Mat& src, std::size_t kernelSize) {
+    pp::Mat dst(src.rows, src.cols);
+    pp::DoFilter(src, dst, pp::MedianFilterProc(kernelSize));
+    return dst;
+}
+
+// Совпадают ли центры всех окон kernelSize x kernelSize (первые channels
+// байт пикселя).
+template<class Image>
+bool SameCenters(const Image& result, const pp::Mat& expected, std::size_t kernelSize, std::size_t channels) {
+    const std::size_t r = kernelSize / 2;
+    for (std::size_t row = r; row + r < expected.rows; ++row) {
+        for (std::size_t col = r; col + r < expected.cols; ++col) {
+            const uint8_t* a = result.GetPtr(row, col);
+            const uint8_t* b = expected.GetPtr(row, col);
+            if (std::memcmp(a, b, channels) != 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template<class Processor>
+void ExpectMatchesReference(const Processor& proc, std::size_t kernelSize) {
+    std::mt19937 rng(static_cast<unsigned>(kernelSize));
+    std::uniform_int_distribution<std::size_t> extent(kernelSize, kernelSize + 40);
+
+    for (pp::CpuLevel level: kLevels) {
+        if (level > pp::DetectedCpuLevel()) {
+            continue;
+        }
+        SCOPED_TRACE(pp::ToString(level));
+        pp::ForceCpuLevel(level);
+
+        for (int iteration = 0; iteration < 8; ++iteration) {
+            const std::size_t rows = extent(rng);
+            const std::size_t cols = extent(rng);
+            SCOPED_TRACE(testing::Message() << rows << "x" << cols);
+
+            pp::Mat src = RandomMat(rows, cols, rng);
+            const pp::Mat expected = ReferenceMedian(src, kernelSize);
+
+            pp::Mat dst(rows, cols);
+            pp::DoFilter(src, dst, proc);
+            EXPECT_TRUE(SameCenters(dst, expected, kernelSize, 3));
+
+            // Плоскость - первый канал кадра.
+            pp::Plane plane(rows, cols);
+            for (std::size_t row = 0; row < rows; ++row) {
+                for (std::size_t col = 0; col < cols; ++col) {
+                    *plane.GetPtr(row, col) = *src.GetPtr(row, col);
+                }
+            }
+            pp::Plane planeDst(rows, cols);
+            pp::DoFilter(plane, planeDst, proc);
+            EXPECT_TRUE(SameCenters(planeDst, expected, kernelSize, 1));
+        }
+    }
+    pp::ResetCpuLevel();
+}
+
+TEST(NetworkMedian, Matches3x3Reference) {
+    ExpectMatchesReference(pp::NetworkMedianFilterProc<3>(), 3);
+}
+
+TEST(NetworkMedian, Matches5x5Reference) {
+    ExpectMatchesReference(pp::NetworkMedianFilterProc<5>(), 5);
+}
+
+TEST(HistogramMedian, MatchesReference) {
+    for (std::size_t kernelSize: {3, 5, 7, 9, 15}) {
+        SCOPED_TRACE(kernelSize);
+        ExpectMatchesReference(pp::HistogramMedianFilterProc(kernelSize), kernelSize);
+    }
+}
+
+} // namespace
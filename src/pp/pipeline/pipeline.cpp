@@ -0,0 +1,258 @@
+#include "pp/pipeline/pipeline.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace pp {
+namespace {
+
+using Index = std::ptrdiff_t;
+
+// Отражение координаты за краем, как в MakeMirrorBorder.
+Index Reflect(Index i, Index size) {
+    return BorderIndex(i, size, BorderMode::kReflect);
+}
+
+// Плитка [y0, y0 + height) x [x0, x0 + width) во внутренних координатах
+// изображения rows x cols. Буферы плитки хранят её вместе с перекрытием
+// halo[0]: локальная клетка (0, 0) соответствует (y0 - halo[0], x0 - halo[0]).
+class TileRunner {
+public:
+    TileRunner(const std::vector<PipelineStage>& stages, std::size_t tileSize, MatPool& pool)
+     : stages_{stages}, halo_(stages.size() + 1, 0), pool_{pool} {
+        for (std::size_t s = stages.size(); s > 0; --s) {
+            halo_[s - 1] = halo_[s] + stages[s - 1].kernelSize / 2;
+        }
+        const std::size_t side = tileSize + 2 * halo_[0];
+        in_ = pool_.Acquire(side, side);
+        out_ = pool_.Acquire(side, side);
+    }
+
+    ~TileRunner() {
+        pool_.Release(std::move(in_));
+        pool_.Release(std::move(out_));
+    }
+
+    void Run(const Mat& src, Mat& dst, Index y0, Index x0, Index height, Index width) {
+        const Index rows = src.rows - 2 * src.borderSize;
+        const Index cols = src.cols - 2 * src.borderSize;
+        const Index halo = halo_[0];
+
+        for (Index i = y0 - halo; i < y0 + height + halo; ++i) {
+            const uint8_t* row = src.GetPtr(src.borderSize + Reflect(i, rows), src.borderSize);
+            CopyRowBordered(row, cols, x0 - halo, width + 2 * halo, 3, Border{}, in_.GetPtr(i - y0 + halo, 0));
+        }
+
+        for (std::size_t s = 0; s < stages_.size(); ++s) {
+            const Index r = stages_[s].kernelSize / 2;
+            const Index h = halo_[s + 1];
+
+            // Считаем только клетки внутри изображения, остальное - отражение.
+            const Index i0 = std::max<Index>(y0 - h, 0);
+            const Index i1 = std::min<Index>(y0 + height + h, rows);
+            const Index j0 = std::max<Index>(x0 - h, 0);
+            const Index j1 = std::min<Index>(x0 + width + h, cols);
+
+            const Rect windows(j0 - x0 + halo - r, i0 - y0 + halo - r, j1 - j0, i1 - i0);
+            stages_[s].process(in_, out_, windows);
+
+            MirrorRing(y0, x0, height, width, h, rows, cols);
+            std::swap(in_, out_);
+        }
+
+        for (Index i = 0; i < height; ++i) {
+            std::memcpy(dst.GetPtr(dst.borderSize + y0 + i, dst.borderSize + x0),
+                        in_.GetPtr(halo + i, halo), width * 3);
+        }
+    }
+
+private:
+    uint8_t* Local(Index i, Index j, Index y0, Index x0) {
+        return out_.GetPtr(i - y0 + halo_[0], j - x0 + halo_[0]);
+    }
+
+    // Заполняет клетки out_ за краем изображения (в пределах перекрытия h)
+    // отражением посчитанных: сначала столбцы, затем строки целиком.
+    void MirrorRing(Index y0, Index x0, Index height, Index width, Index h, Index rows, Index cols) {
+        const Index i0 = std::max<Index>(y0 - h, 0);
+        const Index i1 = std::min<Index>(y0 + height + h, rows);
+
+        for (Index i = i0; i < i1; ++i) {
+            for (Index j = x0 - h; j < 0; ++j) {
+                std::memcpy(Local(i, j, y0, x0), Local(i, Reflect(j, cols), y0, x0), 3);
+            }
+            for (Index j = cols; j < x0 + width + h; ++j) {
+                std::memcpy(Local(i, j, y0, x0), Local(i, Reflect(j, cols), y0, x0), 3);
+            }
+        }
+
+        const std::size_t rowBytes = (width + 2 * h) * 3;
+        for (Index i = y0 - h; i < y0 + height + h; ++i) {
+            if (i < i0 || i >= i1) {
+                std::memcpy(Local(i, x0 - h, y0, x0), Local(Reflect(i, rows), x0 - h, y0, x0), rowBytes);
+            }
+        }
+    }
+
+    const std::vector<PipelineStage>& stages_;
+    std::vector<std::size_t> halo_; // halo_[s] - перекрытие на входе стадии s
+    MatPool& pool_;
+    Mat in_;
+    Mat out_;
+};
+
+} // namespace
+
+Mat RunTiledPipeline(const Mat& src, const std::vector<PipelineStage>& stages, std::size_t tileSize) {
+    Mat dst{src.rows, src.cols, src.borderSize};
+    MatPool pool;
+    RunTiledPipeline(src, dst, stages, tileSize, pool);
+
+    return dst;
+}
+
+void RunTiledPipeline(const Mat& src, Mat& dst, const std::vector<PipelineStage>& stages,
+                      std::size_t tileSize, MatPool& pool) {
+    const std::size_t rows = src.rows - 2 * src.borderSize;
+    const std::size_t cols = src.cols - 2 * src.borderSize;
+
+    std::size_t halo = 0;
+    for (const auto& stage: stages) {
+        halo += stage.kernelSize / 2;
+    }
+    if (tileSize == 0 || halo > rows || halo > cols) {
+        throw std::invalid_argument("RunTiledPipeline: tile size is zero or the image is smaller than the total kernel radius");
+    }
+
+    const std::size_t tileRows = (rows + tileSize - 1) / tileSize;
+    const std::size_t tileCols = (cols + tileSize - 1) / tileSize;
+    const std::size_t tiles = tileRows * tileCols;
+
+    #pragma omp parallel
+    {
+        TileRunner runner(stages, tileSize, pool);
+
+        #pragma omp for schedule(dynamic)
+        for (std::size_t t = 0; t < tiles; ++t) {
+            const std::size_t y0 = t / tileCols * tileSize;
+            const std::size_t x0 = t % tileCols * tileSize;
+            const std::size_t height = std::min(tileSize, rows - y0);
+            const std::size_t width = std::min(tileSize, cols - x0);
+
+            runner.Run(src, dst, y0, x0, height, width);
+        }
+    }
+}
+
+StripPipeline::StripPipeline(std::size_t rows, std::size_t cols, const std::vector<PipelineStage>& stages,
+                             std::size_t stripHeight, const Border& border, Sink sink)
+ : rows_{rows}, cols_{cols}, stripHeight_{stripHeight}, border_{border}, sink_{std::move(sink)} {
+    if (stripHeight == 0 || border.mode == BorderMode::kWrap) {
+        throw std::invalid_argument("StripPipeline: strip height is zero or the border is wrap");
+    }
+
+    // Стадия получает полосы не выше chunk строк: на выходе стадии полоса
+    // может вырасти на radius строк, дождавшихся нижнего края.
+    std::size_t chunk = stripHeight;
+    for (const auto& stage: stages) {
+        const std::size_t r = stage.kernelSize / 2;
+        // 2r строк перекрытия, полоса и r строк за нижним краем кадра.
+        const std::size_t capacity = chunk + 3 * r;
+
+        Stage st{stage, r, Mat(capacity, cols + 2 * r, r), Mat(capacity, cols + 2 * r, r)};
+        // Строки [-r, 0) заполняются, когда придут первые строки кадра.
+        st.first = -static_cast<Index>(r);
+        st.filled = r;
+        stages_.push_back(std::move(st));
+
+        chunk += r;
+    }
+}
+
+void StripPipeline::Push(const Mat& strip) {
+    if (strip.rows == 0 || strip.rows > stripHeight_ || strip.cols != cols_ || pushed_ + strip.rows > rows_) {
+        throw std::invalid_argument("StripPipeline: strip does not fit the image or the strip height");
+    }
+    pushed_ += strip.rows;
+
+    Push(0, strip);
+}
+
+void StripPipeline::FillRow(Stage& st, Index row) {
+    uint8_t* dst = st.in.GetPtr(row - st.first, 0);
+    const Index src = BorderIndex(row, rows_, border_.mode);
+    if (src < 0) {
+        std::memset(dst, border_.value, st.in.cols * 3);
+    } else {
+        std::memcpy(dst, st.in.GetPtr(src - st.first, 0), st.in.cols * 3);
+    }
+}
+
+void StripPipeline::Push(std::size_t s, const Mat& strip) {
+    if (s == stages_.size()) {
+        sink_(strip);
+        return;
+    }
+
+    Stage& st = stages_[s];
+    const Index r = st.radius;
+
+    for (std::size_t i = 0; i < strip.rows; ++i) {
+        CopyRowBordered(strip.GetPtr(i, 0), cols_, -r, cols_ + 2 * r, 3, border_, st.in.GetPtr(st.filled, 0));
+        ++st.filled;
+        ++st.received;
+    }
+
+    // Строке результата y нужны строки входа до y + r включительно.
+    const bool last = st.received == rows_;
+    const std::size_t end = last ? rows_ : (st.received > st.radius ? st.received - st.radius : 0);
+    if (end <= st.next) {
+        return;
+    }
+
+    if (st.next == 0) {
+        for (Index i = -r; i < 0; ++i) {
+            FillRow(st, i);
+        }
+    }
+    if (last) {
+        for (Index i = rows_; i < static_cast<Index>(rows_) + r; ++i) {
+            FillRow(st, i);
+        }
+        st.filled += st.radius;
+    }
+
+    // in(0) - строка next - r, поэтому окна строк результата начинаются с 0.
+    const std::size_t count = end - st.next;
+    #pragma omp parallel
+    {
+        const std::size_t threads = omp_get_num_threads();
+        const std::size_t id = omp_get_thread_num();
+        const std::size_t begin = count * id / threads;
+        const std::size_t bandEnd = count * (id + 1) / threads;
+
+        if (begin < bandEnd) {
+            st.stage.process(st.in, st.out, Rect(0, begin, cols_, bandEnd - begin));
+        }
+    }
+    const Mat result = st.out.Crop(Rect(r, r, cols_, count));
+
+    // Перекрытие [end - r, ...) переносится в начало in.
+    st.next = end;
+    const std::size_t shift = count;
+    const std::size_t keep = st.filled - shift;
+    for (std::size_t i = 0; i < keep; ++i) {
+        std::memcpy(st.in.GetPtr(i, 0), st.in.GetPtr(i + shift, 0), st.in.cols * 3);
+    }
+    st.first += shift;
+    st.filled = keep;
+
+    Push(s + 1, result);
+}
+
+} // namespace pp
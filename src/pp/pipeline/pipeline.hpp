@@ -0,0 +1,97 @@
+#ifndef IMAGE_PREPROCESSING_PP_PIPELINE_HPP_
+#define IMAGE_PREPROCESSING_PP_PIPELINE_HPP_
+
+#include "pp/border/border.hpp"
+#include "pp/mat/mat.hpp"
+#include "pp/pool/pool.hpp"
+#include "pp/transformation/transformation.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace pp {
+
+// Одна стадия конвейера: окно kernelSize x kernelSize и обработка
+// прямоугольника окон с теми же соглашениями, что у DoFilter.
+struct PipelineStage {
+    std::size_t kernelSize;
+    std::function<void(Mat& src, Mat& dst, const Rect& windows)> process;
+};
+
+template<class Processor>
+PipelineStage MakePipelineStage(const Processor& proc) {
+    return PipelineStage{
+        proc.kernelSize,
+        [proc](Mat& src, Mat& dst, const Rect& windows) {
+            DoFilter(src, dst, proc, windows);
+        },
+    };
+}
+
+// Прогоняет все стадии по плиткам tileSize x tileSize внутренней части src
+// (без рамки src.borderSize): каждая плитка с перекрытием на суммарный радиус
+// окон проходит весь конвейер, пока промежуточные результаты лежат в кэше,
+// и только результат последней стадии пишется в полный кадр.
+// Клетки за краем изображения на каждой стадии отражаются так же, как это
+// делает MakeMirrorBorder, поэтому внутренняя часть результата совпадает
+// с поэтапным применением стадий. Плитки обрабатываются параллельно (OpenMP).
+// Полный кадр читается один раз и один раз пишется, а не по разу на стадию:
+// для k стадий это расчётное снижение трафика к памяти примерно в k раз
+// (плюс перекрытие плиток); аппаратными счётчиками оно не измерялось.
+// Суммарный радиус окон не должен превышать размеров изображения.
+Mat RunTiledPipeline(const Mat& src, const std::vector<PipelineStage>& stages, std::size_t tileSize);
+
+// То же, но результат пишется в dst того же размера, что src, а буферы
+// плиток берутся из pool.
+void RunTiledPipeline(const Mat& src, Mat& dst, const std::vector<PipelineStage>& stages,
+                      std::size_t tileSize, MatPool& pool);
+
+// Потоковое выполнение стадий по горизонтальным полосам кадра rows x cols,
+// который целиком в памяти не держится: строки подаются Push по порядку,
+// а готовые строки результата отдаются sink по мере готовности. Каждая
+// стадия хранит только пришедшую полосу и kernelSize / 2 строк перекрытия
+// сверху и снизу, перенося их в следующую полосу вместо повторного счёта,
+// поэтому память зависит от stripHeight x cols, а не от размера кадра.
+// Края достраиваются по border; kWrap не поддерживается - для него нужны
+// строки с другого конца кадра. Результат совпадает с поэтапным
+// применением стадий ко всему кадру.
+class StripPipeline {
+public:
+    // strip - очередные готовые строки результата (cols пикселей, без рамки).
+    using Sink = std::function<void(const Mat& strip)>;
+
+    StripPipeline(std::size_t rows, std::size_t cols, const std::vector<PipelineStage>& stages,
+                  std::size_t stripHeight, const Border& border, Sink sink);
+
+    // strip - следующие строки кадра: от 1 до stripHeight строк по cols
+    // пикселей. После последней строки кадра sink получает остаток результата.
+    void Push(const Mat& strip);
+
+private:
+    struct Stage {
+        PipelineStage stage;
+        std::size_t radius;
+        Mat in;                    // строки входа с рамкой radius слева и справа
+        Mat out;                   // та же геометрия, результат для строк in
+        std::ptrdiff_t first = 0;  // строка кадра, лежащая в in(0)
+        std::size_t filled = 0;    // заполнено строк in
+        std::size_t received = 0;  // получено строк кадра
+        std::size_t next = 0;      // следующая строка результата
+    };
+
+    void Push(std::size_t s, const Mat& strip);
+    void FillRow(Stage& stage, std::ptrdiff_t row);
+
+    std::size_t rows_;
+    std::size_t cols_;
+    std::size_t stripHeight_;
+    std::size_t pushed_ = 0;
+    Border border_;
+    Sink sink_;
+    std::vector<Stage> stages_;
+};
+
+} // namespace pp
+
+#endif
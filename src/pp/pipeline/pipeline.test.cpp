@@ -0,0 +1,160 @@
+#include "pp/pipeline/pipeline.hpp"
+
+#include "pp/cpu/cpu.hpp"
+#include "pp/mean/mean.hpp"
+#include "pp/median/median.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+constexpr pp::CpuLevel kLevels[] = {
+    pp::CpuLevel::kScalar, pp::CpuLevel::kSse41, pp::CpuLevel::kAvx2, pp::CpuLevel::kAvx512,
+};
+
+pp::Mat RandomMat(std::size_t rows, std::size_t cols, std::mt19937& rng) {
+    std::uniform_int_distribution<int> value(0, 255);
+    pp::Mat img(rows, cols);
+    for (std::size_t row = 0; row < rows; ++row) {
+        for (std::size_t j = 0; j < cols * 3; ++j) {
+            img.GetPtr(row, 0)[j] = static_cast<uint8_t>(value(rng));
+        }
+    }
+    return img;
+}
+
+std::vector<pp::PipelineStage> Stages() {
+    return {
+        pp::MakePipelineStage(pp::HistogramMedianFilterProc(5)),
+        pp::MakePipelineStage(pp::BoxMeanFilterProc(3)),
+        pp::MakePipelineStage(pp::SobelFilterProc()),
+        pp::MakePipelineStage(pp::ThresholdFilterProc(100)),
+    };
+}
+
+// Поэтапное применение стадий: перед каждой кадр получает физическую
+// рамку, достроенную по border попиксельно.
+pp::Mat ApplyStages(const pp::Mat& src, const std::vector<pp::PipelineStage>& stages, const pp::Border& border) {
+    pp::Mat img = src;
+    for (const auto& stage: stages) {
+        const std::size_t r = stage.kernelSize / 2;
+        const auto rows = static_cast<std::ptrdiff_t>(img.rows);
+        const auto cols = static_cast<std::ptrdiff_t>(img.cols);
+        const auto pad = static_cast<std::ptrdiff_t>(r);
+
+        pp::Mat padded(img.rows + 2 * r, img.cols + 2 * r);
+        for (std::ptrdiff_t i = -pad; i < rows + pad; ++i) {
+            for (std::ptrdiff_t j = -pad; j < cols + pad; ++j) {
+                uint8_t* dst = padded.GetPtr(i + pad, j + pad);
+                const std::ptrdiff_t y = pp::BorderIndex(i, rows, border.mode);
+                const std::ptrdiff_t x = pp::BorderIndex(j, cols, border.mode);
+                if (y < 0 || x < 0) {
+                    std::memset(dst, border.value, 3);
+                } else {
+                    std::memcpy(dst, img.GetPtr(y, x), 3);
+                }
+            }
+        }
+
+        pp::Mat out(padded.rows, padded.cols);
+        stage.process(padded, out, pp::Rect(0, 0, img.cols, img.rows));
+        for (std::size_t row = 0; row < img.rows; ++row) {
+            std::memcpy(img.GetPtr(row, 0), out.GetPtr(row + r, r), img.cols * 3);
+        }
+    }
+    return img;
+}
+
+TEST(TiledPipeline, MatchesStageByStage) {
+    const auto stages = Stages();
+    std::mt19937 rng(1);
+    // Суммарный радиус стадий - 4.
+    std::uniform_int_distribution<std::size_t> extent(4, 60);
+    std::uniform_int_distribution<std::size_t> tile(1, 33);
+
+    for (pp::CpuLevel level: kLevels) {
+        if (level > pp::DetectedCpuLevel()) {
+            continue;
+        }
+        SCOPED_TRACE(pp::ToString(level));
+        pp::ForceCpuLevel(level);
+
+        for (int iteration = 0; iteration < 10; ++iteration) {
+            const std::size_t rows = extent(rng);
+            const std::size_t cols = extent(rng);
+            const std::size_t tileSize = tile(rng);
+            SCOPED_TRACE(testing::Message() << rows << "x" << cols << " tile " << tileSize);
+
+            const pp::Mat src = RandomMat(rows, cols, rng);
+            EXPECT_TRUE(pp::RunTiledPipeline(src, stages, tileSize) == ApplyStages(src, stages, pp::Border{}));
+        }
+    }
+    pp::ResetCpuLevel();
+}
+
+TEST(TiledPipeline, RejectsFrameSmallerThanRadius) {
+    const pp::Mat src(3, 10);
+    EXPECT_THROW(pp::RunTiledPipeline(src, Stages(), 8), std::invalid_argument);
+}
+
+TEST(StripPipeline, MatchesStageByStage) {
+    const auto stages = Stages();
+    std::mt19937 rng(2);
+    std::uniform_int_distribution<std::size_t> extent(1, 50);
+    std::uniform_int_distribution<std::size_t> strip(1, 20);
+
+    for (pp::CpuLevel level: kLevels) {
+        if (level > pp::DetectedCpuLevel()) {
+            continue;
+        }
+        SCOPED_TRACE(pp::ToString(level));
+        pp::ForceCpuLevel(level);
+
+        for (pp::BorderMode mode: {pp::BorderMode::kReflect, pp::BorderMode::kReplicate, pp::BorderMode::kConstant}) {
+            SCOPED_TRACE(pp::ToString(mode));
+            const pp::Border border{mode, 200};
+
+            for (int iteration = 0; iteration < 6; ++iteration) {
+                const std::size_t rows = extent(rng);
+                const std::size_t cols = extent(rng);
+                const std::size_t stripHeight = strip(rng);
+                SCOPED_TRACE(testing::Message() << rows << "x" << cols << " strip " << stripHeight);
+
+                const pp::Mat src = RandomMat(rows, cols, rng);
+                pp::Mat result(rows, cols);
+                std::size_t written = 0;
+                pp::StripPipeline pipeline(rows, cols, stages, stripHeight, border, [&](const pp::Mat& rowsOut) {
+                    ASSERT_LE(written + rowsOut.rows, rows);
+                    for (std::size_t row = 0; row < rowsOut.rows; ++row) {
+                        std::memcpy(result.GetPtr(written + row, 0), rowsOut.GetPtr(row, 0), cols * 3);
+                    }
+                    written += rowsOut.rows;
+                });
+
+                pp::Mat frame = src;
+                for (std::size_t row = 0; row < rows; row += stripHeight) {
+                    const std::size_t height = std::min(stripHeight, rows - row);
+                    pipeline.Push(frame.Crop(pp::Rect(0, row, cols, height)));
+                }
+
+                EXPECT_EQ(written, rows);
+                EXPECT_TRUE(result == ApplyStages(src, stages, border));
+            }
+        }
+    }
+    pp::ResetCpuLevel();
+}
+
+TEST(StripPipeline, RejectsWrapBorder) {
+    const pp::Border wrap{pp::BorderMode::kWrap, 0};
+    EXPECT_THROW(pp::StripPipeline(8, 8, Stages(), 4, wrap, [](const pp::Mat&) {}), std::invalid_argument);
+}
+
+} // namespace
@@ -54,14 +54,17 @@ PixelRGB::PixelRGB(PixelHSI pixel): PixelRGB() {
         params.v3 = &r();
     }
 
-    *params.v1 = roundAndStaticCast<uint8_t>(pixel.i()*(1 - pixel.s()));
+    // I нормирована, как V в PixelHSV.
+    const double I = pixel.i() * 255.;
+
+    *params.v1 = roundAndStaticCast<uint8_t>(I*(1 - pixel.s()));
         
     const double tmp =
         ( pixel.s() * cosDegree(params.H) ) /
             cosDegree(60 - params.H);
-    *params.v2 = roundAndStaticCast<uint8_t>(pixel.i()*(1. + tmp));
+    *params.v2 = roundAndStaticCast<uint8_t>(I*(1. + tmp));
 
-    *params.v3 = 3.*pixel.i() - (*params.v1 + *params.v2);
+    *params.v3 = roundAndStaticCast<uint8_t>(3.*I - (*params.v1 + *params.v2));
 }
 
 PixelRGB::PixelRGB(PixelHSV pixel): PixelRGB() {
@@ -183,7 +186,7 @@ PixelHSI::PixelHSI(PixelRGB pixel) {
                    (pixel.rn() - pixel.bn()) * (pixel.gn() - pixel.bn()),
                0.5) +
       1e-6;
-  double teta = std::acos(tetaUpper / tetaLower);
+  double teta = std::acos(tetaUpper / tetaLower) * 180. / M_PI;
 
   if (pixel.b() <= pixel.g()) {
     h() = teta;
@@ -195,7 +198,7 @@ PixelHSI::PixelHSI(PixelRGB pixel) {
   auto min = 0 + std::min({ pixel.rn(), pixel.gn(), pixel.bn() });
   s() = 1. - (3.*min)/sum;
 
-  i() = 1./(3.*sum);
+  i() = sum / 3.;
 }
 
 PixelHSV::PixelHSV(double H, double S, double V) {
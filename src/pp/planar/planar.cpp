@@ -0,0 +1,151 @@
+#include "pp/planar/planar.hpp"
+#include "pp/cpu/cpu.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace pp {
+namespace {
+
+PP_ALWAYS_INLINE void DeinterleaveRowImpl(const uint8_t* s, uint8_t* r, uint8_t* g, uint8_t* b,
+                                          std::size_t cols) {
+    #pragma omp simd
+    for (std::size_t col = 0; col < cols; ++col) {
+        r[col] = s[col * 3 + PixelRGB::Pos::R];
+        g[col] = s[col * 3 + PixelRGB::Pos::G];
+        b[col] = s[col * 3 + PixelRGB::Pos::B];
+    }
+}
+
+PP_ALWAYS_INLINE void InterleaveRowImpl(const uint8_t* r, const uint8_t* g, const uint8_t* b, uint8_t* d,
+                                        std::size_t cols) {
+    #pragma omp simd
+    for (std::size_t col = 0; col < cols; ++col) {
+        d[col * 3 + PixelRGB::Pos::R] = r[col];
+        d[col * 3 + PixelRGB::Pos::G] = g[col];
+        d[col * 3 + PixelRGB::Pos::B] = b[col];
+    }
+}
+
+PP_CPU_VARIANTS(void, DeinterleaveRow, DeinterleaveRowImpl,
+                (const uint8_t* s, uint8_t* r, uint8_t* g, uint8_t* b, std::size_t cols),
+                (s, r, g, b, cols))
+
+PP_CPU_VARIANTS(void, InterleaveRow, InterleaveRowImpl,
+                (const uint8_t* r, const uint8_t* g, const uint8_t* b, uint8_t* d, std::size_t cols),
+                (r, g, b, d, cols))
+
+void DeinterleaveRow(const uint8_t* s, uint8_t* r, uint8_t* g, uint8_t* b, std::size_t cols) {
+    PP_CPU_DISPATCH(DeinterleaveRow, (s, r, g, b, cols));
+}
+
+void InterleaveRow(const uint8_t* r, const uint8_t* g, const uint8_t* b, uint8_t* d, std::size_t cols) {
+    PP_CPU_DISPATCH(InterleaveRow, (r, g, b, d, cols));
+}
+
+} // namespace
+
+Plane::Plane()
+    : rows{0}, cols{0}, step{0}, data{nullptr} {}
+
+Plane::Plane(std::size_t rows, std::size_t cols, std::size_t borderSize)
+    : rows{rows}, cols{cols}, step{AlignedBytes(cols, 1)},
+      data{AllocAligned(AlignedBytes(rows, step))}, borderSize{borderSize} {}
+
+Plane::Plane(const Plane& other): Plane(other.rows, other.cols, other.borderSize) {
+    if (data != nullptr) {
+        std::memcpy(data, other.data, rows * step);
+    }
+}
+
+Plane::~Plane() {
+    if (data != nullptr) {
+        FreeAligned(data);
+    }
+}
+
+bool Plane::operator==(const Plane& other) const {
+    if (rows != other.rows || cols != other.cols) {
+        return false;
+    }
+
+    for (std::size_t row = 0; row < rows; ++row) {
+        if (std::memcmp(GetPtr(row, 0), other.GetPtr(row, 0), cols) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Plane::MakeMirrorBorder(std::size_t borderSize) {
+    // Те же отражения, что у Mat::MakeMirrorBorder: сначала левый и правый
+    // края внутренних строк, затем верх и низ целыми строками (вместе с углами).
+    for (std::size_t row = borderSize; row < rows - borderSize; ++row) {
+        MirrorRowEdges(GetPtr(row, 0), cols, borderSize, 1);
+    }
+
+    for (std::size_t i = 0; i < borderSize; ++i) {
+        std::memcpy(GetPtr(borderSize - 1 - i, 0), GetPtr(borderSize + i, 0), cols);
+        std::memcpy(GetPtr(rows - borderSize + i, 0), GetPtr(rows - borderSize - 1 - i, 0), cols);
+    }
+}
+
+PlanarMat::PlanarMat()
+    : rows{0}, cols{0} {}
+
+PlanarMat::PlanarMat(std::size_t rows, std::size_t cols, std::size_t borderSize)
+    : rows{rows}, cols{cols}, borderSize{borderSize},
+      planes{Plane(rows, cols, borderSize), Plane(rows, cols, borderSize), Plane(rows, cols, borderSize)} {}
+
+PlanarMat::PlanarMat(const Mat& img): PlanarMat() {
+    Deinterleave(img, *this);
+}
+
+Mat PlanarMat::ToMat() const {
+    Mat result;
+    Interleave(*this, result);
+
+    return result;
+}
+
+void PlanarMat::MakeMirrorBorder(std::size_t borderSize) {
+    for (auto& plane: planes) {
+        plane.MakeMirrorBorder(borderSize);
+    }
+}
+
+void Deinterleave(const Mat& src, PlanarMat& dst) {
+    if (dst.rows != src.rows || dst.cols != src.cols) {
+        PlanarMat(src.rows, src.cols).swap(dst);
+    }
+    dst.borderSize = src.borderSize;
+    for (auto& plane: dst.planes) {
+        plane.borderSize = src.borderSize;
+    }
+
+    for (std::size_t row = 0; row < src.rows; ++row) {
+        const uint8_t* s = src.GetPtr(row, 0);
+        uint8_t* r = dst[PixelRGB::Pos::R].GetPtr(row, 0);
+        uint8_t* g = dst[PixelRGB::Pos::G].GetPtr(row, 0);
+        uint8_t* b = dst[PixelRGB::Pos::B].GetPtr(row, 0);
+        DeinterleaveRow(s, r, g, b, src.cols);
+    }
+}
+
+void Interleave(const PlanarMat& src, Mat& dst) {
+    if (dst.rows != src.rows || dst.cols != src.cols) {
+        Mat(src.rows, src.cols).swap(dst);
+    }
+    dst.borderSize = src.borderSize;
+
+    for (std::size_t row = 0; row < src.rows; ++row) {
+        const uint8_t* r = src[PixelRGB::Pos::R].GetPtr(row, 0);
+        const uint8_t* g = src[PixelRGB::Pos::G].GetPtr(row, 0);
+        const uint8_t* b = src[PixelRGB::Pos::B].GetPtr(row, 0);
+        uint8_t* d = dst.GetPtr(row, 0);
+        InterleaveRow(r, g, b, d, src.cols);
+    }
+}
+
+} // namespace pp
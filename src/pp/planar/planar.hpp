@@ -0,0 +1,113 @@
+#ifndef IMAGE_PREPROCESSING_PP_PLANAR_HPP_
+#define IMAGE_PREPROCESSING_PP_PLANAR_HPP_
+
+#include "pp/mat/mat.hpp"
+#include "pp/pixel/pixel.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace pp {
+
+// Одноканальное изображение. Строки выровнены на kRowAlignment байт,
+// step - расстояние между строками (cols, дополненное до кратного
+// kRowAlignment). Как и у Mat, rows и cols включают рамку borderSize.
+class Plane {
+public:
+    Plane();
+
+    ~Plane();
+
+    Plane(std::size_t rows, std::size_t cols, std::size_t borderSize = 0);
+
+    Plane(const Plane& other);
+    Plane(Plane&& other): Plane() {
+        other.swap(*this);
+    }
+
+    Plane& operator=(const Plane& other) {
+        Plane(other).swap(*this);
+
+        return *this;
+    }
+
+    Plane& operator=(Plane&& other) {
+        Plane(std::move(other)).swap(*this);
+
+        return *this;
+    }
+
+    void swap(Plane& other) {
+        using std::swap;
+
+        swap(rows, other.rows);
+        swap(cols, other.cols);
+        swap(step, other.step);
+        swap(data, other.data);
+        swap(borderSize, other.borderSize);
+    }
+
+    bool operator==(const Plane& other) const;
+    bool operator!=(const Plane& other) const {
+        return !(*this == other);
+    }
+
+    uint8_t* GetPtr(std::size_t row, std::size_t col) { return data + row * step + col; }
+    const uint8_t* GetPtr(std::size_t row, std::size_t col) const { return data + row * step + col; }
+
+    void MakeMirrorBorder(std::size_t borderSize);
+
+    std::size_t rows;
+    std::size_t cols;
+    std::size_t step;
+    uint8_t* data;
+    std::size_t borderSize = 0;
+};
+
+// Планарное (SoA) RGB-изображение: три отдельные плоскости одного размера,
+// индексируются PixelRGB::Pos.
+class PlanarMat {
+public:
+    PlanarMat();
+
+    PlanarMat(std::size_t rows, std::size_t cols, std::size_t borderSize = 0);
+
+    // Разделение чередующегося Mat по плоскостям.
+    explicit PlanarMat(const Mat& img);
+
+    void swap(PlanarMat& other) {
+        using std::swap;
+
+        swap(rows, other.rows);
+        swap(cols, other.cols);
+        swap(borderSize, other.borderSize);
+        for (std::size_t i = 0; i < planes.size(); ++i) {
+            planes[i].swap(other.planes[i]);
+        }
+    }
+
+    bool operator==(const PlanarMat& other) const { return planes == other.planes; }
+    bool operator!=(const PlanarMat& other) const { return !(*this == other); }
+
+    Plane& operator[](PixelRGB::Pos pos) { return planes[pos]; }
+    const Plane& operator[](PixelRGB::Pos pos) const { return planes[pos]; }
+
+    // Сборка обратно в чередующийся Mat.
+    Mat ToMat() const;
+
+    void MakeMirrorBorder(std::size_t borderSize);
+
+    std::size_t rows;
+    std::size_t cols;
+    std::size_t borderSize = 0;
+    std::array<Plane, 3> planes;
+};
+
+void Deinterleave(const Mat& src, PlanarMat& dst);
+void Interleave(const PlanarMat& src, Mat& dst);
+
+} // namespace pp
+
+#endif
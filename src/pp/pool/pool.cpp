@@ -0,0 +1,105 @@
+#include "pp/pool/pool.hpp"
+
+#include <omp.h>
+
+namespace pp {
+
+MatPool::MatPool(): MatPool(2 * static_cast<std::size_t>(omp_get_max_threads()) + 8) {}
+
+MatPool::MatPool(std::size_t maxPerShape): maxPerShape_{maxPerShape} {}
+
+Mat MatPool::Acquire(std::size_t rows, std::size_t cols, std::size_t borderSize, Mat::Placement placement) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto it = free_.find(Shape{rows, cols});
+        if (it != free_.end() && !it->second.empty()) {
+            Mat mat = std::move(it->second.back());
+            it->second.pop_back();
+            mat.borderSize = borderSize;
+
+            return mat;
+        }
+    }
+
+    return Mat{rows, cols, borderSize, placement};
+}
+
+void MatPool::Release(Mat&& mat) {
+    Mat released;
+    released.swap(mat);
+    if (!released.OwnsAlignedBuffer()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& mats = free_[Shape{released.rows, released.cols}];
+    if (mats.size() < maxPerShape_) {
+        mats.push_back(std::move(released));
+    }
+}
+
+Plane MatPool::AcquirePlane(std::size_t rows, std::size_t cols, std::size_t borderSize) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto it = freePlanes_.find(Shape{rows, cols});
+        if (it != freePlanes_.end() && !it->second.empty()) {
+            Plane plane = std::move(it->second.back());
+            it->second.pop_back();
+            plane.borderSize = borderSize;
+
+            return plane;
+        }
+    }
+
+    return Plane{rows, cols, borderSize};
+}
+
+void MatPool::Release(Plane&& plane) {
+    Plane released;
+    released.swap(plane);
+    if (released.data == nullptr || released.step != AlignedBytes(released.cols, 1)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& planes = freePlanes_[Shape{released.rows, released.cols}];
+    if (planes.size() < maxPerShape_) {
+        planes.push_back(std::move(released));
+    }
+}
+
+PlanarMat MatPool::AcquirePlanar(std::size_t rows, std::size_t cols, std::size_t borderSize) {
+    PlanarMat img;
+    img.rows = rows;
+    img.cols = cols;
+    img.borderSize = borderSize;
+    for (auto& plane: img.planes) {
+        plane = AcquirePlane(rows, cols, borderSize);
+    }
+
+    return img;
+}
+
+void MatPool::Release(PlanarMat&& img) {
+    for (auto& plane: img.planes) {
+        Release(std::move(plane));
+    }
+    PlanarMat().swap(img);
+}
+
+std::size_t MatPool::Size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::size_t size = 0;
+    for (const auto& [shape, mats]: free_) {
+        size += mats.size();
+    }
+    for (const auto& [shape, planes]: freePlanes_) {
+        size += planes.size();
+    }
+    return size;
+}
+
+} // namespace pp
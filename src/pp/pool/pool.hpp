@@ -0,0 +1,58 @@
+#ifndef IMAGE_PREPROCESSING_PP_POOL_HPP_
+#define IMAGE_PREPROCESSING_PP_POOL_HPP_
+
+#include "pp/mat/mat.hpp"
+#include "pp/planar/planar.hpp"
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace pp {
+
+// Пул буферов изображений, сгруппированных по размеру rows x cols:
+// чередующихся Mat и одноканальных Plane (из них же собираются PlanarMat).
+// После первого кадра конвейер берёт промежуточные буферы отсюда и не
+// обращается к куче. Свободных буферов одного размера (каждого вида)
+// хранится не больше maxPerShape, лишние освобождаются. Потокобезопасен.
+class MatPool {
+public:
+    // maxPerShape по умолчанию покрывает пару буферов плитки на каждый поток
+    // OpenMP и буферы уровня кадра.
+    MatPool();
+    explicit MatPool(std::size_t maxPerShape);
+
+    // Свободный буфер нужного размера или новый, размещённый placement.
+    // Содержимое не определено.
+    Mat Acquire(std::size_t rows, std::size_t cols, std::size_t borderSize = 0,
+                Mat::Placement placement = Mat::Placement::kDefault);
+
+    // Возвращает буфер в пул; mat становится пустым. Пулится только целое
+    // изображение в собственном буфере Mat (Mat::OwnsAlignedBuffer); окна,
+    // внешние и отображённые в память буферы просто отпускаются.
+    void Release(Mat&& mat);
+
+    Plane AcquirePlane(std::size_t rows, std::size_t cols, std::size_t borderSize = 0);
+    void Release(Plane&& plane);
+
+    // Три плоскости из пула; Release возвращает их туда же.
+    PlanarMat AcquirePlanar(std::size_t rows, std::size_t cols, std::size_t borderSize = 0);
+    void Release(PlanarMat&& img);
+
+    // Число свободных буферов в пуле.
+    std::size_t Size() const;
+
+private:
+    using Shape = std::pair<std::size_t, std::size_t>;
+
+    std::size_t maxPerShape_;
+    std::map<Shape, std::vector<Mat>> free_;
+    std::map<Shape, std::vector<Plane>> freePlanes_;
+    mutable std::mutex mutex_;
+};
+
+} // namespace pp
+
+#endif
@@ -0,0 +1,186 @@
+#include "pp/raw/raw.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace pp {
+namespace {
+
+RawHeader MakeHeader(std::size_t rows, std::size_t cols, std::size_t channels) {
+    RawHeader header{};
+    std::memcpy(header.magic, kRawMagic, sizeof(kRawMagic));
+    header.rows = rows;
+    header.cols = cols;
+    header.channels = channels;
+    header.step = AlignUp(cols * channels, kRowAlignment);
+    header.layout = static_cast<uint64_t>(RawLayout::kInterleaved);
+    header.dataOffset = sizeof(RawHeader);
+
+    return header;
+}
+
+// Строки rows x rowBytes из src с шагом srcStep, дополненные нулями до header.step.
+void WriteRaw(const std::string& path, const RawHeader& header, const uint8_t* src, std::size_t srcStep) {
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    const std::size_t rowBytes = header.cols * header.channels;
+    const std::vector<char> padding(header.step - rowBytes, 0);
+    for (std::size_t row = 0; row < header.rows && file; ++row) {
+        file.write(reinterpret_cast<const char*>(src + row * srcStep), rowBytes);
+        file.write(padding.data(), padding.size());
+    }
+
+    if (!file) {
+        throw std::runtime_error("Cannot write raw image: " + path);
+    }
+}
+
+} // namespace
+
+void CheckRawHeader(const RawHeader& header, std::size_t fileSize, const std::string& path,
+                    std::size_t channels) {
+    if (std::memcmp(header.magic, kRawMagic, sizeof(kRawMagic)) != 0) {
+        throw std::runtime_error("Not a raw image: " + path);
+    }
+    if (header.layout != static_cast<uint64_t>(RawLayout::kInterleaved) || header.channels != channels) {
+        throw std::runtime_error("Expected an interleaved " + std::to_string(channels) +
+                                 "-channel raw image: " + path);
+    }
+    // Без умножений: rows и cols из файла могут переполнить uint64_t.
+    if (header.step == 0 || header.step % kRowAlignment != 0 || header.cols > header.step / header.channels ||
+        header.dataOffset % kRowAlignment != 0 || header.dataOffset > fileSize ||
+        header.rows > (fileSize - header.dataOffset) / header.step) {
+        throw std::runtime_error("Bad raw image header: " + path);
+    }
+}
+
+bool IsRawImage(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[sizeof(kRawMagic)] = {};
+
+    return file.read(magic, sizeof(magic)) && std::memcmp(magic, kRawMagic, sizeof(kRawMagic)) == 0;
+}
+
+#ifndef _WIN32
+
+Mat MapRawImage(const std::string& path, MapMode mode) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open raw image: " + path);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(RawHeader)) {
+        close(fd);
+        throw std::runtime_error("Bad raw image header: " + path);
+    }
+    const std::size_t length = st.st_size;
+
+    // MAP_PRIVATE с PROT_WRITE даёт копирование при записи; дескриптор
+    // после mmap не нужен.
+    const int prot = mode == MapMode::kReadOnly ? PROT_READ : PROT_READ | PROT_WRITE;
+    const int flags = mode == MapMode::kReadOnly ? MAP_SHARED : MAP_PRIVATE;
+    void* base = mmap(nullptr, length, prot, flags, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        throw std::runtime_error("Cannot map raw image: " + path);
+    }
+
+    RawHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    try {
+        CheckRawHeader(header, length, path);
+    } catch (...) {
+        munmap(base, length);
+        throw;
+    }
+
+    uint8_t* data = static_cast<uint8_t*>(base) + header.dataOffset;
+    return Mat(header.rows, header.cols, header.step, data,
+               [base, length](uint8_t*) { munmap(base, length); });
+}
+
+#else
+
+// Без mmap: файл читается в выровненный буфер.
+Mat MapRawImage(const std::string& path, MapMode) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        throw std::runtime_error("Cannot open raw image: " + path);
+    }
+    const std::size_t length = file.tellg();
+    if (length < sizeof(RawHeader)) {
+        throw std::runtime_error("Bad raw image header: " + path);
+    }
+
+    uint8_t* base = AllocAligned(length);
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(base), length);
+
+    RawHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    try {
+        if (!file) {
+            throw std::runtime_error("Cannot read raw image: " + path);
+        }
+        CheckRawHeader(header, length, path);
+    } catch (...) {
+        FreeAligned(base);
+        throw;
+    }
+
+    return Mat(header.rows, header.cols, header.step, base + header.dataOffset,
+               [base](uint8_t*) { FreeAligned(base); });
+}
+
+#endif
+
+Plane ReadRawPlane(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        throw std::runtime_error("Cannot open raw image: " + path);
+    }
+    const std::size_t length = file.tellg();
+
+    RawHeader header;
+    file.seekg(0);
+    if (length < sizeof(RawHeader) || !file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        throw std::runtime_error("Bad raw image header: " + path);
+    }
+    CheckRawHeader(header, length, path, 1);
+
+    Plane plane(header.rows, header.cols);
+    for (std::size_t row = 0; row < plane.rows; ++row) {
+        file.seekg(header.dataOffset + row * header.step);
+        if (!file.read(reinterpret_cast<char*>(plane.GetPtr(row, 0)), plane.cols)) {
+            throw std::runtime_error("Cannot read raw image: " + path);
+        }
+    }
+
+    return plane;
+}
+
+void WriteRawImage(const std::string& path, const Mat& img) {
+    const std::size_t b = img.borderSize;
+    WriteRaw(path, MakeHeader(img.rows - 2 * b, img.cols - 2 * b, 3), img.GetPtr(b, b), img.step);
+}
+
+void WriteRawImage(const std::string& path, const Plane& img) {
+    const std::size_t b = img.borderSize;
+    WriteRaw(path, MakeHeader(img.rows - 2 * b, img.cols - 2 * b, 1), img.GetPtr(b, b), img.step);
+}
+
+} // namespace pp
@@ -0,0 +1,70 @@
+#ifndef IMAGE_PREPROCESSING_PP_RAW_HPP_
+#define IMAGE_PREPROCESSING_PP_RAW_HPP_
+
+#include "pp/mat/mat.hpp"
+#include "pp/planar/planar.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace pp {
+
+// Несжатый формат кадра для обмена между запусками конвейера: заголовок
+// RawHeader и rows строк по step байт, начиная с dataOffset. Строки и
+// начало данных выровнены на kRowAlignment, поэтому отображённый в память
+// файл используется как Mat без декодирования и копий. Числа в заголовке
+// хранятся в порядке байт записавшей машины.
+struct RawHeader {
+    char magic[8];       // kRawMagic
+    uint64_t rows;       // без рамки
+    uint64_t cols;
+    uint64_t channels;   // 3 (BGR, как в Mat) или 1 (Plane)
+    uint64_t step;       // байт между началами строк
+    uint64_t layout;     // RawLayout
+    uint64_t dataOffset; // смещение первой строки от начала файла
+    uint64_t reserved;
+};
+
+static_assert(sizeof(RawHeader) == kRowAlignment, "RawHeader must keep the pixel data aligned");
+
+constexpr char kRawMagic[8] = {'P', 'P', 'R', 'A', 'W', '\0', '\0', '1'};
+
+// Расширение файлов, которые imgio пишет в этом формате.
+constexpr char kRawExtension[] = ".ppraw";
+
+enum class RawLayout : uint64_t {
+    kInterleaved = 0, // каналы пикселя подряд; другие значения - для планарного хранения
+};
+
+enum class MapMode {
+    kReadOnly,    // общие страницы только для чтения: запись в Mat недопустима
+    kCopyOnWrite, // изменённые страницы копируются и в файл не попадают
+};
+
+// Проверяет заголовок файла path размером fileSize: сигнатуру, раскладку
+// (interleaved-кадр с channels каналами: 3 для Mat, 1 для Plane),
+// выравнивание и то, что строки помещаются в файл. Ошибка -
+// std::runtime_error.
+void CheckRawHeader(const RawHeader& header, std::size_t fileSize, const std::string& path,
+                    std::size_t channels = 3);
+
+// Начинается ли файл с kRawMagic.
+bool IsRawImage(const std::string& path);
+
+// Отображает файл в память и возвращает Mat поверх его пикселей (без рамки);
+// отображение снимается вместе с последним Mat и окном Crop на него.
+// Ошибки чтения и неверный заголовок - std::runtime_error.
+Mat MapRawImage(const std::string& path, MapMode mode = MapMode::kCopyOnWrite);
+
+// Читает одноканальный кадр (такой пишет WriteRawImage для Plane) в Plane
+// без рамки. Ошибки чтения и неверный заголовок - std::runtime_error.
+Plane ReadRawPlane(const std::string& path);
+
+// Записывает внутреннюю область img (без рамки).
+void WriteRawImage(const std::string& path, const Mat& img);
+void WriteRawImage(const std::string& path, const Plane& img);
+
+} // namespace pp
+
+#endif
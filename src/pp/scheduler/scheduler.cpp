@@ -0,0 +1,120 @@
+#include "pp/scheduler/scheduler.hpp"
+
+namespace pp {
+
+ThreadPool::ThreadPool(std::size_t numThreads) {
+    numThreads = std::max<std::size_t>(numThreads, 1);
+
+    for (std::size_t i = 0; i < numThreads; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    for (std::size_t i = 0; i < numThreads; ++i) {
+        threads_.emplace_back(&ThreadPool::WorkerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+
+    for (auto& thread: threads_) {
+        thread.join();
+    }
+}
+
+void ThreadPool::ParallelFor(std::size_t count, const std::function<void(std::size_t)>& task) {
+    if (count == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> callLock(callMutex_);
+
+    // Потоки сейчас простаивают (active_ == 0), очереди можно заполнять.
+    const std::size_t numThreads = queues_.size();
+    for (std::size_t i = 0; i < numThreads; ++i) {
+        std::lock_guard<std::mutex> lock(queues_[i]->mutex);
+        for (std::size_t t = count * i / numThreads; t < count * (i + 1) / numThreads; ++t) {
+            queues_[i]->tasks.push_back(t);
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    remaining_ = count;
+    task_ = &task;
+    ++generation_;
+    wake_.notify_all();
+
+    // Ждём и выполнения всех задач, и выхода потоков из цикла, чтобы ни один
+    // не остался с указателем на task после возврата.
+    done_.wait(lock, [this] { return remaining_ == 0 && active_ == 0; });
+    task_ = nullptr;
+}
+
+void ThreadPool::WorkerLoop(std::size_t id) {
+    std::size_t seen = 0;
+
+    for (;;) {
+        const std::function<void(std::size_t)>* task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+            if (stop_) {
+                return;
+            }
+            seen = generation_;
+            task = task_;
+            if (task == nullptr) {
+                continue;
+            }
+            ++active_;
+        }
+
+        std::size_t t;
+        while (Pop(id, t) || Steal(id, t)) {
+            (*task)(t);
+            --remaining_;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --active_;
+        }
+        done_.notify_all();
+    }
+}
+
+bool ThreadPool::Pop(std::size_t id, std::size_t& task) {
+    Queue& queue = *queues_[id];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = queue.tasks.front();
+    queue.tasks.pop_front();
+
+    return true;
+}
+
+bool ThreadPool::Steal(std::size_t id, std::size_t& task) {
+    const std::size_t numThreads = queues_.size();
+
+    for (std::size_t i = 1; i < numThreads; ++i) {
+        Queue& queue = *queues_[(id + i) % numThreads];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (!queue.tasks.empty()) {
+            task = queue.tasks.back();
+            queue.tasks.pop_back();
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+} // namespace pp
@@ -0,0 +1,158 @@
+#ifndef IMAGE_PREPROCESSING_PP_SCHEDULER_HPP_
+#define IMAGE_PREPROCESSING_PP_SCHEDULER_HPP_
+
+#include "pp/border/border.hpp"
+#include "pp/mat/mat.hpp"
+#include "pp/transformation/transformation.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace pp {
+
+// Постоянный пул потоков с кражей задач, не зависящий от OpenMP.
+// ParallelFor раздаёт индексы задач непрерывными кусками по очередям
+// потоков; поток берёт задачи из начала своей очереди, а опустевший
+// поток крадёт их с конца чужой. Так дорогие участки кадра (адаптивные
+// фильтры, ранний выход) не задерживают весь проход.
+class ThreadPool {
+public:
+    explicit ThreadPool(std::size_t numThreads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Выполняет task(i) для всех i из [0, count) и ждёт завершения.
+    // task не должна бросать исключения и снова вызывать ParallelFor.
+    void ParallelFor(std::size_t count, const std::function<void(std::size_t)>& task);
+
+    std::size_t NumThreads() const {
+        return threads_.size();
+    }
+
+private:
+    struct Queue {
+        std::deque<std::size_t> tasks;
+        std::mutex mutex;
+    };
+
+    void WorkerLoop(std::size_t id);
+    bool Pop(std::size_t id, std::size_t& task);
+    bool Steal(std::size_t id, std::size_t& task);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+
+    std::mutex callMutex_; // один ParallelFor за раз
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(std::size_t)>* task_ = nullptr;
+    std::size_t generation_ = 0;
+    std::size_t active_ = 0;
+    std::atomic<std::size_t> remaining_{0};
+    bool stop_ = false;
+};
+
+// Очередь ограниченной ёмкости между стадиями конвейера потоков: Push ждёт
+// свободного места, Pop - элемента. После Close Pop отдаёт оставшиеся
+// элементы, а затем возвращает false; Push после Close не допускается.
+template<class T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(std::size_t capacity): capacity_{capacity} {}
+
+    void Push(T value) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notFull_.wait(lock, [this] { return items_.size() < capacity_; });
+        items_.push_back(std::move(value));
+        notEmpty_.notify_one();
+    }
+
+    bool Pop(T& value) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [this] { return !items_.empty() || closed_; });
+        if (items_.empty()) {
+            return false;
+        }
+        value = std::move(items_.front());
+        items_.pop_front();
+        notFull_.notify_one();
+
+        return true;
+    }
+
+    void Close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        notEmpty_.notify_all();
+    }
+
+private:
+    const std::size_t capacity_;
+    std::deque<T> items_;
+    bool closed_ = false;
+    std::mutex mutex_;
+    std::condition_variable notFull_;
+    std::condition_variable notEmpty_;
+};
+
+// DoFilter, раздающий окна плитками tileSize x tileSize потокам pool.
+// Каждая плитка обрабатывается своей копией proc, поэтому результат
+// совпадает с последовательным DoFilter. Image - Mat или PlanarMat.
+template<class Image, class Processor>
+void DoFilter(Image& src, Image& dst, Processor proc, const Rect& windows,
+              ThreadPool& pool, std::size_t tileSize) {
+    const std::size_t tileRows = (windows.height + tileSize - 1) / tileSize;
+    const std::size_t tileCols = (windows.width + tileSize - 1) / tileSize;
+
+    pool.ParallelFor(tileRows * tileCols, [&](std::size_t t) {
+        const std::size_t y = windows.y + t / tileCols * tileSize;
+        const std::size_t x = windows.x + t % tileCols * tileSize;
+        const std::size_t height = std::min(tileSize, windows.y + windows.height - y);
+        const std::size_t width = std::min(tileSize, windows.x + windows.width - x);
+
+        DoFilter(src, dst, proc, Rect(x, y, width, height));
+    });
+}
+
+template<class Image, class Processor>
+void DoFilter(Image& src, Image& dst, Processor proc, ThreadPool& pool, std::size_t tileSize) {
+    const std::size_t kernelSize = proc.kernelSize;
+    const Rect windows(0, 0, src.cols - kernelSize + 1, src.rows - kernelSize + 1);
+
+    DoFilter(src, dst, proc, windows, pool, tileSize);
+}
+
+// То же без физической рамки (см. DoFilter с Border): плитки
+// tileSize x tileSize делят пиксели кадра, а плитки у края достраивают
+// свои полосы по border.
+template<class Image, class Processor>
+void DoFilter(Image& src, Image& dst, Processor proc, const Border& border,
+              ThreadPool& pool, std::size_t tileSize) {
+    const std::size_t tileRows = (src.rows + tileSize - 1) / tileSize;
+    const std::size_t tileCols = (src.cols + tileSize - 1) / tileSize;
+
+    pool.ParallelFor(tileRows * tileCols, [&](std::size_t t) {
+        const std::size_t y = t / tileCols * tileSize;
+        const std::size_t x = t % tileCols * tileSize;
+        const std::size_t height = std::min(tileSize, src.rows - y);
+        const std::size_t width = std::min(tileSize, src.cols - x);
+
+        DoFilter(src, dst, proc, border, Rect(x, y, width, height));
+    });
+}
+
+} // namespace pp
+
+#endif
@@ -0,0 +1,111 @@
+#include "pp/scheduler/scheduler.hpp"
+
+#include "pp/mean/mean.hpp"
+#include "pp/median/median.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+pp::Mat RandomMat(std::size_t rows, std::size_t cols, std::mt19937& rng) {
+    std::uniform_int_distribution<int> value(0, 255);
+    pp::Mat img(rows, cols);
+    for (std::size_t row = 0; row < rows; ++row) {
+        for (std::size_t j = 0; j < cols * 3; ++j) {
+            img.GetPtr(row, 0)[j] = static_cast<uint8_t>(value(rng));
+        }
+    }
+    return img;
+}
+
+TEST(ThreadPool, RunsEveryTaskOnce) {
+    for (std::size_t threads: {1, 2, 3, 8}) {
+        pp::ThreadPool pool(threads);
+        for (std::size_t count: {0, 1, 5, 1000}) {
+            SCOPED_TRACE(testing::Message() << threads << " threads, " << count << " tasks");
+
+            std::vector<std::atomic<int>> runs(count);
+            pool.ParallelFor(count, [&](std::size_t i) { ++runs[i]; });
+            for (const auto& run: runs) {
+                EXPECT_EQ(run.load(), 1);
+            }
+        }
+    }
+}
+
+// Неравномерные задачи: пока один поток занят дорогой задачей, остальные
+// забирают его очередь, и ParallelFor дожидается всех.
+TEST(ThreadPool, CompletesUnevenTasks) {
+    pp::ThreadPool pool(4);
+    std::atomic<std::size_t> done{0};
+    pool.ParallelFor(64, [&](std::size_t i) {
+        volatile std::size_t spin = 0;
+        for (std::size_t k = 0; k < (i == 0 ? 2000000 : 10); ++k) {
+            spin = spin + k;
+        }
+        ++done;
+    });
+    EXPECT_EQ(done.load(), 64u);
+}
+
+template<class Processor>
+void ExpectMatchesSequential(const Processor& proc) {
+    std::mt19937 rng(static_cast<unsigned>(proc.kernelSize));
+    std::uniform_int_distribution<std::size_t> extent(proc.kernelSize, 70);
+    std::uniform_int_distribution<std::size_t> tile(1, 40);
+    pp::ThreadPool pool(3);
+
+    for (int iteration = 0; iteration < 8; ++iteration) {
+        const std::size_t rows = extent(rng);
+        const std::size_t cols = extent(rng);
+        const std::size_t tileSize = tile(rng);
+        SCOPED_TRACE(testing::Message() << rows << "x" << cols << " tile " << tileSize);
+
+        // Окна не покрывают рамку kernelSize / 2: она остаётся от src.
+        pp::Mat src = RandomMat(rows, cols, rng);
+        pp::Mat expected = src;
+        pp::Mat dst = src;
+        pp::DoFilter(src, expected, proc);
+        pp::DoFilter(src, dst, proc, pool, tileSize);
+        EXPECT_TRUE(dst == expected);
+
+        pp::PlanarMat planarSrc(src);
+        pp::PlanarMat planarExpected(src);
+        pp::PlanarMat planarDst(src);
+        pp::DoFilter(planarSrc, planarExpected, proc);
+        pp::DoFilter(planarSrc, planarDst, proc, pool, tileSize);
+        EXPECT_TRUE(planarDst == planarExpected);
+
+        for (pp::BorderMode mode: {pp::BorderMode::kReflect, pp::BorderMode::kReplicate,
+                                   pp::BorderMode::kConstant, pp::BorderMode::kWrap}) {
+            SCOPED_TRACE(pp::ToString(mode));
+            const pp::Border border{mode, 9};
+
+            pp::Mat bordered(rows, cols);
+            pp::Mat borderedDst(rows, cols);
+            pp::DoFilter(src, bordered, proc, border);
+            pp::DoFilter(src, borderedDst, proc, border, pool, tileSize);
+            EXPECT_TRUE(borderedDst == bordered);
+        }
+    }
+}
+
+TEST(ScheduledDoFilter, BoxMeanMatchesSequential) {
+    ExpectMatchesSequential(pp::BoxMeanFilterProc(5));
+}
+
+TEST(ScheduledDoFilter, HistogramMedianMatchesSequential) {
+    ExpectMatchesSequential(pp::HistogramMedianFilterProc(7));
+}
+
+TEST(ScheduledDoFilter, SobelMatchesSequential) {
+    ExpectMatchesSequential(pp::SobelFilterProc());
+}
+
+} // namespace
@@ -1,7 +1,10 @@
 #include "pp/transformation/transformation.hpp"
+#include "pp/cpu/cpu.hpp"
+#include "pp/gradient/gradient.hpp"
 #include "pp/pixel/pixel.hpp"
 
 #include <cstdint>
+#include <cstdlib>
 #include <random>
 #include <vector>
 #include <algorithm>
@@ -15,6 +18,25 @@ T roundAndStaticCast(double val) {
     return static_cast<T>(std::round(val));
 }
 
+PP_ALWAYS_INLINE void ThresholdImpl(const uint8_t* src, std::size_t srcStep,
+                                    uint8_t* dst, std::size_t dstStep,
+                                    std::size_t rows, std::size_t bytes, uint8_t thresholdValue) {
+    for (std::size_t row = 0; row < rows; ++row) {
+        const uint8_t* s = src + row * srcStep;
+        uint8_t* d = dst + row * dstStep;
+
+        #pragma omp simd
+        for (std::size_t i = 0; i < bytes; ++i) {
+            d[i] = (s[i] < thresholdValue) ? 0 : 255;
+        }
+    }
+}
+
+PP_CPU_VARIANTS(void, Threshold, ThresholdImpl,
+                (const uint8_t* src, std::size_t srcStep, uint8_t* dst, std::size_t dstStep,
+                 std::size_t rows, std::size_t bytes, uint8_t thresholdValue),
+                (src, srcStep, dst, dstStep, rows, bytes, thresholdValue))
+
 int32_t ApplyKernel(ROI& roi, std::vector<int32_t> kernel, PixelRGB::Pos pos) {
     int32_t result = 0;
 
@@ -92,12 +114,143 @@ void ThresholdFilterProc::operator()(ROI& roi, PixelRGBRef& dst) {
     dst.b() = (pixel.b() < thresholdValue) ? 0 : 255;
 }
 
+void Threshold(const uint8_t* src, std::size_t srcStep,
+               uint8_t* dst, std::size_t dstStep,
+               std::size_t rows, std::size_t cols, std::size_t channels,
+               uint8_t thresholdValue) {
+    PP_CPU_DISPATCH(Threshold, (src, srcStep, dst, dstStep, rows, cols * channels, thresholdValue));
+}
+
+void ThresholdFilterProc::ProcessBlock(Mat& src, Mat& dst, const Rect& windows) const {
+    Threshold(src.GetPtr(windows.y, windows.x), src.step,
+              dst.GetPtr(windows.y, windows.x), dst.step,
+              windows.height, windows.width, 3, thresholdValue);
+}
+
+void ThresholdFilterProc::ProcessBlock(Plane& src, Plane& dst, const Rect& windows) const {
+    Threshold(src.GetPtr(windows.y, windows.x), src.step,
+              dst.GetPtr(windows.y, windows.x), dst.step,
+              windows.height, windows.width, 1, thresholdValue);
+}
+
 void SegmentationFilterProc::operator()(ROI& roi, PixelRGBRef& dst) {
     return (this->*proc_)(roi, dst);
 }
 
+bool SegmentationFilterProc::UseGradientEngine() const {
+    auto weight = [](const std::vector<int32_t>& kernel) {
+        int32_t sum = 0;
+        for (int32_t k: kernel) {
+            sum += std::abs(k);
+        }
+        return sum;
+    };
+
+    return kernelSize == 3
+        && weight(kernelX_) <= kMaxGradientKernelWeight
+        && weight(kernelY_) <= kMaxGradientKernelWeight;
+}
+
+void SegmentationFilterProc::ProcessBlock(Mat& src, Mat& dst, const Rect& windows) {
+    if (param_ != kEachChannelSeparately && UseGradientEngine()) {
+        GrayGradient3x3(src, dst, windows, kernelX_.data(), kernelY_.data());
+        return;
+    }
+
+    const int half_k = kernelSize / 2;
+    for (std::size_t row = windows.y; row < windows.y + windows.height; ++row) {
+        for (std::size_t col = windows.x; col < windows.x + windows.width; ++col) {
+            Rect rect(col, row, kernelSize, kernelSize);
+            ROI roi(src, rect);
+            PixelRGBRef pixel = dst.GetPixel(row + half_k, col + half_k);
+
+            (*this)(roi, pixel);
+        }
+    }
+}
+
+void SegmentationFilterProc::ProcessBlock(PlanarMat& src, PlanarMat& dst, const Rect& windows) {
+    if (UseGradientEngine()) {
+        if (param_ == kEachChannelSeparately) {
+            for (std::size_t ch = 0; ch < src.planes.size(); ++ch) {
+                const Plane& plane = src.planes[ch];
+                Plane& out = dst.planes[ch];
+                GradientMagnitude3x3(plane.GetPtr(windows.y, windows.x), plane.step,
+                                     out.GetPtr(windows.y + 1, windows.x + 1), out.step,
+                                     windows.height, windows.width, kernelX_.data(), kernelY_.data());
+            }
+        } else {
+            GrayGradient3x3(src, dst, windows, kernelX_.data(), kernelY_.data());
+        }
+        return;
+    }
+
+    const std::size_t half_k = kernelSize / 2;
+
+    auto gradient = [this](auto&& value, std::size_t row, std::size_t col) {
+        int32_t gx = 0;
+        int32_t gy = 0;
+        for (std::size_t i = 0; i < kernelSize; ++i) {
+            for (std::size_t j = 0; j < kernelSize; ++j) {
+                const int32_t v = value(row + i, col + j);
+                gx += kernelX_[i * kernelSize + j] * v;
+                gy += kernelY_[i * kernelSize + j] * v;
+            }
+        }
+        return CalculateMagnitude(gx, gy);
+    };
+
+    for (std::size_t row = windows.y; row < windows.y + windows.height; ++row) {
+        for (std::size_t col = windows.x; col < windows.x + windows.width; ++col) {
+            if (param_ == kEachChannelSeparately) {
+                for (std::size_t ch = 0; ch < src.planes.size(); ++ch) {
+                    const Plane& plane = src.planes[ch];
+                    auto value = [&plane](std::size_t r, std::size_t c) { return *plane.GetPtr(r, c); };
+                    *dst.planes[ch].GetPtr(row + half_k, col + half_k) = gradient(value, row, col);
+                }
+            } else {
+                auto value = [&src](std::size_t r, std::size_t c) {
+                    PixelRGB pixel(*src[PixelRGB::Pos::R].GetPtr(r, c),
+                                   *src[PixelRGB::Pos::G].GetPtr(r, c),
+                                   *src[PixelRGB::Pos::B].GetPtr(r, c));
+                    return pixel.grayscale();
+                };
+                const uint8_t magnitude = gradient(value, row, col);
+                for (auto& plane: dst.planes) {
+                    *plane.GetPtr(row + half_k, col + half_k) = magnitude;
+                }
+            }
+        }
+    }
+}
+
+void SegmentationFilterProc::ProcessBlock(Plane& src, Plane& dst, const Rect& windows) {
+    if (UseGradientEngine()) {
+        GradientMagnitude3x3(src.GetPtr(windows.y, windows.x), src.step,
+                             dst.GetPtr(windows.y + 1, windows.x + 1), dst.step,
+                             windows.height, windows.width, kernelX_.data(), kernelY_.data());
+        return;
+    }
+
+    const std::size_t half_k = kernelSize / 2;
+    for (std::size_t row = windows.y; row < windows.y + windows.height; ++row) {
+        for (std::size_t col = windows.x; col < windows.x + windows.width; ++col) {
+            int32_t gx = 0;
+            int32_t gy = 0;
+            for (std::size_t i = 0; i < kernelSize; ++i) {
+                const uint8_t* s = src.GetPtr(row + i, col);
+                for (std::size_t j = 0; j < kernelSize; ++j) {
+                    gx += kernelX_[i * kernelSize + j] * s[j];
+                    gy += kernelY_[i * kernelSize + j] * s[j];
+                }
+            }
+            *dst.GetPtr(row + half_k, col + half_k) = CalculateMagnitude(gx, gy);
+        }
+    }
+}
+
 SegmentationFilterProc::SegmentationFilterProc(const std::vector<int32_t>& kernelX, const std::vector<int32_t>& kernelY, std::size_t kernelSize, SegmentationFiltersParam param)
- : kernelSize(kernelSize), kernelX_ {kernelX}, kernelY_ {kernelY} {
+ : kernelSize(kernelSize), kernelX_ {kernelX}, kernelY_ {kernelY}, param_ {param} {
     switch (param) {
         case kGrayScale:
             proc_ = &SegmentationFilterProc::ProcGrayScale;
@@ -2,7 +2,12 @@
 #define IMAGE_PREPROCESSING_PP_TRANSFORMATION_HPP_
 
 #include "pp/mat/mat.hpp"
+#include "pp/planar/planar.hpp"
 
+#include <omp.h>
+
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace pp {
@@ -25,10 +30,19 @@ public:
     std::size_t kernelSize;
 };
 
+// Бинаризация rows x cols пикселей по channels байт: 0 для значений меньше
+// thresholdValue, иначе 255.
+void Threshold(const uint8_t* src, std::size_t srcStep,
+               uint8_t* dst, std::size_t dstStep,
+               std::size_t rows, std::size_t cols, std::size_t channels,
+               uint8_t thresholdValue);
+
 class ThresholdFilterProc {
 public:
     ThresholdFilterProc(uint8_t thresholdValue): thresholdValue(thresholdValue) {}
     void operator()(ROI& roi, PixelRGBRef& dst);
+    void ProcessBlock(Mat& src, Mat& dst, const Rect& windows) const;
+    void ProcessBlock(Plane& src, Plane& dst, const Rect& windows) const;
 
     uint8_t thresholdValue;
     const uint8_t kernelSize = 1;
@@ -45,11 +59,21 @@ public:
     SegmentationFilterProc(const std::vector<int32_t>& kernelX, const std::vector<int32_t>& kernelY, std::size_t kernelSize, SegmentationFiltersParam param = kMaxGradient);
 
     void operator()(ROI& roi, PixelRGBRef& dst);
+    // Ядра 3x3 по яркости (и поканально для PlanarMat) считаются векторным
+    // движком pp/gradient, остальное - по окнам через operator().
+    void ProcessBlock(Mat& src, Mat& dst, const Rect& windows);
+    void ProcessBlock(PlanarMat& src, PlanarMat& dst, const Rect& windows);
+    // Одноканальное изображение - уже яркость, поэтому все режимы дают
+    // модуль градиента самой плоскости.
+    void ProcessBlock(Plane& src, Plane& dst, const Rect& windows);
 
     std::size_t kernelSize;
 private:
+    bool UseGradientEngine() const;
+
     std::vector<int32_t> kernelX_;
     std::vector<int32_t> kernelY_; 
+    SegmentationFiltersParam param_;
 
     using FunProc = void(SegmentationFilterProc::*)(ROI&, PixelRGBRef&);
 
@@ -96,22 +120,131 @@ public:
     ) {}
 };
 
+// Процессор, обрабатывающий сразу прямоугольник окон (скользящие суммы,
+// гистограммы и т.п.), объявляет метод
+//     void ProcessBlock(Mat& src, Mat& dst, const Rect& windows);
+// где windows - левые верхние углы окон в координатах src.
+template<class Processor, class = void>
+struct IsBlockProcessor : std::false_type {};
+
+template<class Processor>
+struct IsBlockProcessor<Processor, std::void_t<decltype(std::declval<Processor&>().ProcessBlock(
+    std::declval<Mat&>(), std::declval<Mat&>(), std::declval<const Rect&>()))>>
+    : std::true_type {};
+
+// Обрабатывает окна с левыми верхними углами из windows.
+// Результат для окна (row, col) пишется в dst(row + half_k, col + half_k).
+template<class Processor>
+void DoFilter(Mat& src, Mat& dst, Processor proc, const Rect& windows) {
+    if constexpr (IsBlockProcessor<Processor>::value) {
+        proc.ProcessBlock(src, dst, windows);
+    } else {
+        const std::size_t kernelSize = proc.kernelSize;
+        int half_k = kernelSize / 2;
+
+        for (std::size_t row = windows.y; row < windows.y + windows.height; ++row) {
+            for (std::size_t col = windows.x; col < windows.x + windows.width; ++col) {
+                Rect rect(col, row, kernelSize, kernelSize);
+                ROI roi(src, rect);
+                PixelRGBRef pixel = dst.GetPixel(row + half_k, col + half_k);
+
+                proc(roi, pixel); // <- операция над изображением
+            }
+        }
+    }
+}
+
 template<class Processor>
 void DoFilter(Mat& src, Mat& dst, Processor proc) {
     const std::size_t kernelSize = proc.kernelSize;
-    int half_k = kernelSize / 2;
+    const Rect windows(0, 0, src.cols - kernelSize + 1, src.rows - kernelSize + 1);
+
+    DoFilter(src, dst, proc, windows);
+}
+
+// Поканальный процессор для планарных изображений объявляет
+//     void ProcessBlock(Plane& src, Plane& dst, const Rect& windows);
+// и применяется к каждой плоскости отдельно, а также к одноканальным
+// изображениям. Процессоры, которым нужны все каналы сразу, объявляют
+// ProcessBlock(PlanarMat&, PlanarMat&, const Rect&); он важнее поканального.
+template<class Processor, class = void>
+struct IsPlaneProcessor : std::false_type {};
+
+template<class Processor>
+struct IsPlaneProcessor<Processor, std::void_t<decltype(std::declval<Processor&>().ProcessBlock(
+    std::declval<Plane&>(), std::declval<Plane&>(), std::declval<const Rect&>()))>>
+    : std::true_type {};
+
+template<class Processor, class = void>
+struct IsPlanarProcessor : std::false_type {};
+
+template<class Processor>
+struct IsPlanarProcessor<Processor, std::void_t<decltype(std::declval<Processor&>().ProcessBlock(
+    std::declval<PlanarMat&>(), std::declval<PlanarMat&>(), std::declval<const Rect&>()))>>
+    : std::true_type {};
+
+template<class Processor>
+void DoFilter(PlanarMat& src, PlanarMat& dst, Processor proc, const Rect& windows) {
+    if constexpr (IsPlanarProcessor<Processor>::value) {
+        proc.ProcessBlock(src, dst, windows);
+    } else {
+        for (std::size_t i = 0; i < src.planes.size(); ++i) {
+            proc.ProcessBlock(src.planes[i], dst.planes[i], windows);
+        }
+    }
+}
+
+template<class Processor>
+void DoFilter(PlanarMat& src, PlanarMat& dst, Processor proc) {
+    const std::size_t kernelSize = proc.kernelSize;
+    const Rect windows(0, 0, src.cols - kernelSize + 1, src.rows - kernelSize + 1);
+
+    DoFilter(src, dst, proc, windows);
+}
+
+// Одноканальное изображение обрабатывают только поканальные процессоры.
+template<class Processor>
+void DoFilter(Plane& src, Plane& dst, Processor proc, const Rect& windows) {
+    static_assert(IsPlaneProcessor<Processor>::value, "Processor has no single-channel ProcessBlock");
+
+    proc.ProcessBlock(src, dst, windows);
+}
+
+template<class Processor>
+void DoFilter(Plane& src, Plane& dst, Processor proc) {
+    const std::size_t kernelSize = proc.kernelSize;
+    const Rect windows(0, 0, src.cols - kernelSize + 1, src.rows - kernelSize + 1);
 
-    for (std::size_t row = 0; row < src.rows - kernelSize + 1; ++row) {
-        for (std::size_t col = 0; col < src.cols - kernelSize + 1; ++col) {
-            Rect rect(col, row, kernelSize, kernelSize);
-            ROI roi(src, rect);
-            PixelRGBRef pixel = dst.GetPixel(row + half_k, col + half_k);
+    DoFilter(src, dst, proc, windows);
+}
 
-            proc(roi, pixel); // <- операция над изображением
+// То же, что DoFilter, но окна делятся на полосы строк по числу потоков
+// OpenMP, и полосы обрабатываются параллельно. Каждый поток работает со своей
+// копией proc, поэтому результат совпадает с последовательным DoFilter.
+// Image - Mat, PlanarMat или Plane.
+template<class Image, class Processor>
+void ParallelDoFilter(Image& src, Image& dst, Processor proc, const Rect& windows) {
+    #pragma omp parallel
+    {
+        const std::size_t threads = omp_get_num_threads();
+        const std::size_t id = omp_get_thread_num();
+        const std::size_t begin = windows.y + windows.height * id / threads;
+        const std::size_t end = windows.y + windows.height * (id + 1) / threads;
+
+        if (begin < end) {
+            DoFilter(src, dst, proc, Rect(windows.x, begin, windows.width, end - begin));
         }
     }
 }
 
+template<class Image, class Processor>
+void ParallelDoFilter(Image& src, Image& dst, Processor proc) {
+    const std::size_t kernelSize = proc.kernelSize;
+    const Rect windows(0, 0, src.cols - kernelSize + 1, src.rows - kernelSize + 1);
+
+    ParallelDoFilter(src, dst, proc, windows);
+}
+
 void InitImg(Mat& src);
 
 // template<class Processor>
@@ -0,0 +1,95 @@
+#include "pp/window/window.hpp"
+#include "pp/cpu/cpu.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace pp {
+namespace {
+
+// Строка результатов: d[x] для x из [0, width), где x - байт первого
+// столбца окна; соседние пиксели окна отстоят на C байт.
+template<std::size_t K, std::size_t C>
+struct MeanRow {
+    PP_ALWAYS_INLINE static void Run(const std::array<const uint8_t*, K>& window,
+                                     uint8_t* d, std::size_t width) {
+        #pragma omp simd
+        for (std::size_t x = 0; x < width; ++x) {
+            uint32_t sum = 0;
+            for (std::size_t i = 0; i < K; ++i) {
+                for (std::size_t j = 0; j < K; ++j) {
+                    sum += window[i][x + j * C];
+                }
+            }
+            // Деление на константу компилируется в умножение.
+            d[x] = static_cast<uint8_t>(sum / (K * K));
+        }
+    }
+};
+
+template<std::size_t K, std::size_t C, template<std::size_t, std::size_t> class Row>
+PP_ALWAYS_INLINE void ForEachWindowRow(const uint8_t* src, std::size_t srcStep,
+                                       uint8_t* dst, std::size_t dstStep,
+                                       std::size_t rows, std::size_t cols) {
+    std::array<const uint8_t*, K> window;
+
+    for (std::size_t row = 0; row < rows; ++row) {
+        for (std::size_t i = 0; i < K; ++i) {
+            window[i] = src + (row + i) * srcStep;
+        }
+        Row<K, C>::Run(window, dst + row * dstStep, cols * C);
+    }
+}
+
+// K и C превращаются в параметры шаблона здесь, внутри варианта под набор
+// инструкций, чтобы каждая специализация собиралась под него.
+template<template<std::size_t, std::size_t> class Row>
+PP_ALWAYS_INLINE void FixedWindowImpl(std::size_t kernelSize, std::size_t channels,
+                                      const uint8_t* src, std::size_t srcStep,
+                                      uint8_t* dst, std::size_t dstStep,
+                                      std::size_t rows, std::size_t cols) {
+    if (channels == 3) {
+        switch (kernelSize) {
+            case 3: ForEachWindowRow<3, 3, Row>(src, srcStep, dst, dstStep, rows, cols); break;
+            case 5: ForEachWindowRow<5, 3, Row>(src, srcStep, dst, dstStep, rows, cols); break;
+            case 7: ForEachWindowRow<7, 3, Row>(src, srcStep, dst, dstStep, rows, cols); break;
+        }
+    } else {
+        switch (kernelSize) {
+            case 3: ForEachWindowRow<3, 1, Row>(src, srcStep, dst, dstStep, rows, cols); break;
+            case 5: ForEachWindowRow<5, 1, Row>(src, srcStep, dst, dstStep, rows, cols); break;
+            case 7: ForEachWindowRow<7, 1, Row>(src, srcStep, dst, dstStep, rows, cols); break;
+        }
+    }
+}
+
+PP_CPU_VARIANTS(void, FixedMeanRows, FixedWindowImpl<MeanRow>,
+                (std::size_t kernelSize, std::size_t channels,
+                 const uint8_t* src, std::size_t srcStep, uint8_t* dst, std::size_t dstStep,
+                 std::size_t rows, std::size_t cols),
+                (kernelSize, channels, src, srcStep, dst, dstStep, rows, cols))
+
+} // namespace
+
+template<std::size_t K, std::size_t C>
+void FixedMean(const uint8_t* src, std::size_t srcStep,
+               uint8_t* dst, std::size_t dstStep,
+               std::size_t rows, std::size_t cols) {
+    PP_CPU_DISPATCH(FixedMeanRows, (K, C, src, srcStep, dst, dstStep, rows, cols));
+}
+
+#define PP_INSTANTIATE_FIXED_WINDOW(K, C)                                               \
+    template void FixedMean<K, C>(const uint8_t*, std::size_t, uint8_t*, std::size_t, \
+                                  std::size_t, std::size_t);
+
+PP_INSTANTIATE_FIXED_WINDOW(3, 1)
+PP_INSTANTIATE_FIXED_WINDOW(3, 3)
+PP_INSTANTIATE_FIXED_WINDOW(5, 1)
+PP_INSTANTIATE_FIXED_WINDOW(5, 3)
+PP_INSTANTIATE_FIXED_WINDOW(7, 1)
+PP_INSTANTIATE_FIXED_WINDOW(7, 3)
+
+#undef PP_INSTANTIATE_FIXED_WINDOW
+
+} // namespace pp
@@ -0,0 +1,53 @@
+#ifndef IMAGE_PREPROCESSING_PP_WINDOW_HPP_
+#define IMAGE_PREPROCESSING_PP_WINDOW_HPP_
+
+#include "pp/mat/mat.hpp"
+#include "pp/planar/planar.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace pp {
+
+// Фильтры по окну K x K, где K и число чередующихся каналов C - параметры
+// шаблона. Окно передаётся K указателями на строки, а не через ROI, поэтому
+// циклы по окну разворачиваются полностью, а пиксели читаются без проверок
+// границ и умножений на шаг строки. Собраны для K = 3, 5, 7 и C = 1, 3.
+// Параметры как у BoxMean.
+
+// Результат совпадает с MeanFilterProc (целочисленное sum / area).
+template<std::size_t K, std::size_t C>
+void FixedMean(const uint8_t* src, std::size_t srcStep,
+               uint8_t* dst, std::size_t dstStep,
+               std::size_t rows, std::size_t cols);
+
+template<std::size_t K>
+class FixedMeanFilterProc {
+    static_assert(K == 3 || K == 5 || K == 7, "FixedMeanFilterProc supports 3x3, 5x5 and 7x7 kernels");
+public:
+    void ProcessBlock(Mat& src, Mat& dst, const Rect& windows) const {
+        if (windows.width == 0 || windows.height == 0) {
+            return;
+        }
+
+        FixedMean<K, 3>(src.GetPtr(windows.y, windows.x), src.step,
+                        dst.GetPtr(windows.y + K / 2, windows.x + K / 2), dst.step,
+                        windows.height, windows.width);
+    }
+
+    void ProcessBlock(Plane& src, Plane& dst, const Rect& windows) const {
+        if (windows.width == 0 || windows.height == 0) {
+            return;
+        }
+
+        FixedMean<K, 1>(src.GetPtr(windows.y, windows.x), src.step,
+                        dst.GetPtr(windows.y + K / 2, windows.x + K / 2), dst.step,
+                        windows.height, windows.width);
+    }
+
+    static constexpr std::size_t kernelSize = K;
+};
+
+} // namespace pp
+
+#endif